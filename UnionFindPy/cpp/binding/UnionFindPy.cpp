@@ -15,104 +15,824 @@
 // You should have received a copy of the GNU General Public License
 // along with UnionFind++.  If not, see <https://www.gnu.org/licenses/>.
 
+#include "BatchDecoder.hpp"
 #include "Decoder.hpp"
 #include "LatticeFromParity.hpp"
+#include "LatticeRepeated.hpp"
+#include "LogicalObservables.hpp"
+#include "VertexOrder.hpp"
 
 #include "pybind11/numpy.h"
 #include "pybind11/pybind11.h"
 #include "pybind11/stl.h"
 
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <span>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
 
-// NOLINTBEGIN(cppcoreguidelines-*)
-void free_arr_uint32(void* p)
+namespace py = pybind11;
+
+namespace
 {
-	uint32_t* p_int = reinterpret_cast<uint32_t*>(p);
-	delete[] p_int;
+/**
+ * @brief Call func with a value of the C++ integer type matching the given numpy
+ * dtype. Boolean arrays are read as uint8_t.
+ */
+template<typename Func> auto visit_integer_dtype(const py::dtype& dtype, Func&& func)
+{
+	switch(dtype.kind())
+	{
+	case 'b':
+		return func(uint8_t{});
+	case 'u':
+		switch(dtype.itemsize())
+		{
+		case 1:
+			return func(uint8_t{});
+		case 2:
+			return func(uint16_t{});
+		case 4:
+			return func(uint32_t{});
+		case 8:
+			return func(uint64_t{});
+		}
+		break;
+	case 'i':
+		switch(dtype.itemsize())
+		{
+		case 1:
+			return func(int8_t{});
+		case 2:
+			return func(int16_t{});
+		case 4:
+			return func(int32_t{});
+		case 8:
+			return func(int64_t{});
+		}
+		break;
+	}
+	throw std::invalid_argument("Array must have a boolean or an integer dtype");
 }
-// NOLINTEND(cppcoreguidelines-*)
 
-namespace py = pybind11;
+auto is_integer_array(const py::array& arr) -> bool
+{
+	const char kind = arr.dtype().kind();
+	return kind == 'b' || kind == 'u' || kind == 'i';
+}
 
-// NOLINTNEXTLINE(cppcoreguidelines-*)
-PYBIND11_MODULE(_union_find_py, m)
+/**
+ * @brief Return the array itself if it is a C-contiguous boolean or integer array, and
+ * a converted uint32 copy otherwise.
+ */
+auto as_integer_array(const py::array& arr) -> py::array
 {
-	using UnionFindFromParity = UnionFindCPP::Decoder<UnionFindCPP::LatticeFromParity>;
-	py::class_<UnionFindFromParity>(m, "DecoderFromParity")
-		.def(py::init(
-			[](int num_parities, int num_qubits,
-			   py::array_t<int, py::array::c_style | py::array::forcecast> col_indices,
-			   py::array_t<int, py::array::c_style | py::array::forcecast> indptr)
-			{
-				if(num_parities <= 0)
-				{
-					throw std::invalid_argument(
-						"Number of partiy operators must be larger than 0");
-				}
-				if(num_qubits <= 0)
+	if(is_integer_array(arr) && (arr.flags() & py::array::c_style) != 0) { return arr; }
+
+	auto converted
+		= py::array_t<uint32_t, py::array::c_style | py::array::forcecast>::ensure(arr);
+	if(!converted)
+	{
+		throw std::invalid_argument("syndromes must be convertible to an integer array");
+	}
+	return converted;
+}
+
+/**
+ * @brief Return the array itself if it is a C-contiguous int32 or int64 array, and a
+ * converted int64 copy otherwise.
+ */
+auto as_index_array(const py::array& arr) -> py::array
+{
+	const auto itemsize = arr.dtype().itemsize();
+	if(arr.dtype().kind() == 'i' && (itemsize == 4 || itemsize == 8)
+	   && (arr.flags() & py::array::c_style) != 0)
+	{
+		return arr;
+	}
+	auto converted
+		= py::array_t<int64_t, py::array::c_style | py::array::forcecast>::ensure(arr);
+	if(!converted) { throw std::invalid_argument("Indices must be an integer array"); }
+	return converted;
+}
+
+/**
+ * @brief Call func with pointers to the data of the CSR index arrays of a parity
+ * matrix after checking the dimensions.
+ *
+ * C-contiguous int32 and int64 arrays, as used by scipy, are read in-place.
+ */
+template<typename Func>
+auto visit_parity_matrix(int num_parities, int num_qubits, const py::array& col_indices,
+						 const py::array& indptr, Func&& func)
+{
+	if(num_parities <= 0)
+	{
+		throw std::invalid_argument("Number of partiy operators must be larger than 0");
+	}
+	if(num_qubits <= 0)
+	{
+		throw std::invalid_argument("Number of qubits must be larger than 0");
+	}
+	if(indptr.ndim() != 1 || indptr.size() != num_parities + 1)
+	{
+		throw std::invalid_argument("Size of indptr must be the number of parities + 1");
+	}
+
+	const auto visit_index_array = [](const py::array& arr, auto&& visitor)
+	{
+		if(arr.dtype().itemsize() == 4)
+		{
+			return visitor(static_cast<const int32_t*>(arr.data()));
+		}
+		return visitor(static_cast<const int64_t*>(arr.data()));
+	};
+
+	const auto col_indices_arr = as_index_array(col_indices);
+	const auto indptr_arr = as_index_array(indptr);
+	return visit_index_array(col_indices_arr,
+							 [&](const auto* col_indices_ptr)
+							 {
+								 return visit_index_array(
+									 indptr_arr, [&](const auto* indptr_ptr)
+									 { return func(col_indices_ptr, indptr_ptr); });
+							 });
+}
+
+/**
+ * @brief Check that out is a writeable C-contiguous boolean or integer array
+ */
+void check_output_array(const py::array& out)
+{
+	if(!is_integer_array(out) || (out.flags() & py::array::c_style) == 0
+	   || !out.writeable())
+	{
+		throw std::invalid_argument(
+			"out must be a writeable C-contiguous array with a boolean or an integer dtype");
+	}
+}
+
+/**
+ * @brief Decode syndromes given as a numpy array and write the corrections to out as a
+ * 0/1 array indexed by edge (qubit).
+ *
+ * A C-contiguous boolean or integer array is read in-place. Other arrays are converted
+ * to uint32 first. The GIL is released while decoding, and corrections are written
+ * directly to out without an intermediate list of edges.
+ */
+template<class Decoder>
+void decode_array(Decoder& decoder, const py::array& syndromes, py::array& out)
+{
+	if(static_cast<size_t>(decoder.num_vertices()) != static_cast<size_t>(syndromes.size()))
+	{
+		throw std::invalid_argument("Size of syndromes should be the same as "
+									"the size of vertices");
+	}
+	if(static_cast<size_t>(out.size()) != static_cast<size_t>(decoder.num_edges()))
+	{
+		throw std::invalid_argument("Size of out should be the same as "
+									"the number of edges");
+	}
+	check_output_array(out);
+
+	const auto arr = as_integer_array(syndromes);
+	visit_integer_dtype(
+		arr.dtype(),
+		[&]<typename T>(T /*tag*/)
+		{
+			const auto data = std::span<const T>(static_cast<const T*>(arr.data()),
+												 static_cast<size_t>(arr.size()));
+			visit_integer_dtype(
+				out.dtype(),
+				[&]<typename U>(U /*tag*/)
 				{
-					throw std::invalid_argument("Number of qubits must be larger than 0");
-				}
-				// check the given dimension is correct
-				return UnionFindFromParity(static_cast<uint32_t>(num_parities),
-										   static_cast<uint32_t>(num_qubits),
-										   static_cast<int*>(col_indices.request().ptr),
-										   static_cast<int*>(indptr.request().ptr));
-			}))
-		.def(py::init(
-			[](int num_parities, int num_qubits,
-			   py::array_t<int, py::array::c_style | py::array::forcecast> col_indices,
-			   py::array_t<int, py::array::c_style | py::array::forcecast> indptr,
-			   int repetitions)
-			{
-				if(num_parities <= 0)
+					auto corrections = std::span<U>(static_cast<U*>(out.mutable_data()),
+													static_cast<size_t>(out.size()));
+					const py::gil_scoped_release release;
+					decoder.decode(data, corrections);
+				});
+		});
+}
+
+/**
+ * @brief Number of qubits of the corrections returned by decode_qubits: the number of
+ * spacelike edges of a layer for a repeated lattice, and of all edges otherwise.
+ */
+template<class Lattice> auto num_qubits(const Lattice& lattice) -> size_t
+{
+	if constexpr(std::is_same_v<Lattice, UnionFindCPP::LatticeRepeated>)
+	{
+		return lattice.layer().num_edges();
+	}
+	else
+	{
+		return lattice.num_edges();
+	}
+}
+
+/**
+ * @brief Turn the edge indices of a correction into the sorted indices of the qubits
+ * to correct, in-place. The layers of a repeated lattice are folded onto one layer.
+ */
+template<class Lattice>
+void to_qubits(const Lattice& lattice, std::vector<uint32_t>& edge_indices)
+{
+	if constexpr(std::is_same_v<Lattice, UnionFindCPP::LatticeRepeated>)
+	{
+		lattice.fold_layers(edge_indices);
+	}
+	else
+	{
+		std::sort(edge_indices.begin(), edge_indices.end());
+	}
+}
+
+[[nodiscard]] constexpr auto packed_size(size_t num_bits) -> size_t
+{
+	return (num_bits + 7) / 8;
+}
+
+/**
+ * @brief Write the given distinct qubits to out as bits packed in the same way as
+ * numpy.packbits with the default big bit order, i.e. qubit q is the bit 7 - q % 8 of
+ * out[q / 8].
+ */
+void pack_qubits(std::span<const uint32_t> qubits, std::span<uint8_t> out)
+{
+	std::fill(out.begin(), out.end(), uint8_t{0});
+	for(const auto qubit : qubits)
+	{
+		out[qubit / 8] |= static_cast<uint8_t>(0x80U >> (qubit % 8));
+	}
+}
+
+/**
+ * @brief Decode syndromes given as a numpy array and write the sorted indices of the
+ * qubits to correct (see to_qubits) to qubits. The GIL is released while decoding.
+ */
+template<class Decoder>
+void decode_qubits_array(Decoder& decoder, const py::array& syndromes,
+						 std::vector<uint32_t>& qubits)
+{
+	if(static_cast<size_t>(decoder.num_vertices())
+	   != static_cast<size_t>(syndromes.size()))
+	{
+		throw std::invalid_argument("Size of syndromes should be the same as "
+									"the size of vertices");
+	}
+
+	const auto arr = as_integer_array(syndromes);
+	visit_integer_dtype(
+		arr.dtype(),
+		[&]<typename T>(T /*tag*/)
+		{
+			const auto data = std::span<const T>(static_cast<const T*>(arr.data()),
+												 static_cast<size_t>(arr.size()));
+			const py::gil_scoped_release release;
+			decoder.decode(data, qubits);
+			to_qubits(decoder.lattice(), qubits);
+		});
+}
+
+/**
+ * @brief Convert defects to a uint32 array after checking that it is 1D and that all
+ * indices are vertices of the decoder
+ */
+template<class Decoder>
+auto as_defects_array(const Decoder& decoder, const py::array& defects)
+	-> py::array_t<uint32_t, py::array::c_style | py::array::forcecast>
+{
+	const auto arr
+		= py::array_t<uint32_t, py::array::c_style | py::array::forcecast>::ensure(defects);
+	if(!arr || arr.ndim() != 1)
+	{
+		throw std::invalid_argument("defects must be a 1D integer array");
+	}
+	const auto num_vertices = static_cast<uint32_t>(decoder.num_vertices());
+	if(std::any_of(arr.data(), arr.data() + arr.size(),
+				   [num_vertices](uint32_t v) { return v >= num_vertices; }))
+	{
+		throw std::invalid_argument("Indices of defects must be smaller than "
+									"the number of vertices");
+	}
+	return arr;
+}
+
+/**
+ * @brief Decode syndromes given as a numpy array and return the logical observables
+ * flipped by the correction as a bitmask. The GIL is released while decoding.
+ */
+template<class Decoder>
+auto decode_observables_array(Decoder& decoder, const py::array& syndromes) -> uint64_t
+{
+	if(static_cast<size_t>(decoder.num_vertices())
+	   != static_cast<size_t>(syndromes.size()))
+	{
+		throw std::invalid_argument("Size of syndromes should be the same as "
+									"the size of vertices");
+	}
+
+	const auto arr = as_integer_array(syndromes);
+	return visit_integer_dtype(
+		arr.dtype(),
+		[&]<typename T>(T /*tag*/)
+		{
+			const auto data = std::span<const T>(static_cast<const T*>(arr.data()),
+												 static_cast<size_t>(arr.size()));
+			const py::gil_scoped_release release;
+			return decoder.decode_observables(data);
+		});
+}
+
+/**
+ * @brief Logical observables from a matrix of shape (num_observables, num_edges) in CSR
+ * format
+ */
+auto make_observables(int num_observables, int num_edges, const py::array& indptr,
+					  const py::array& indices)
+	-> std::shared_ptr<const UnionFindCPP::LogicalObservables>
+{
+	using IndexArray = py::array_t<uint32_t, py::array::c_style | py::array::forcecast>;
+	const auto indptr_arr = IndexArray::ensure(indptr);
+	const auto indices_arr = IndexArray::ensure(indices);
+	if(!indptr_arr || !indices_arr || indptr_arr.ndim() != 1 || indices_arr.ndim() != 1)
+	{
+		throw std::invalid_argument("indptr and indices must be 1D integer arrays");
+	}
+	if(num_observables < 0)
+	{
+		throw std::invalid_argument("Number of observables must be non-negative");
+	}
+	return std::make_shared<const UnionFindCPP::LogicalObservables>(
+		static_cast<uint32_t>(num_observables), static_cast<uint32_t>(num_edges),
+		std::span<const uint32_t>(indptr_arr.data(),
+								  static_cast<size_t>(indptr_arr.size())),
+		std::span<const uint32_t>(indices_arr.data(),
+								  static_cast<size_t>(indices_arr.size())));
+}
+
+/**
+ * @brief Decode a 2D array of syndromes of shape (num_shots, num_vertices) and write the
+ * corrections to out, a 2D array of shape (num_shots, num_edges).
+ *
+ * Shots are decoded by the threads of batch_decoder with the GIL released.
+ */
+template<class BatchDecoder>
+void decode_batch_array(BatchDecoder& batch_decoder, const py::array& syndromes,
+						py::array& out)
+{
+	if(syndromes.ndim() != 2
+	   || static_cast<size_t>(syndromes.shape(1)) != batch_decoder.num_vertices())
+	{
+		throw std::invalid_argument(
+			"syndromes must be a 2D array of shape (num_shots, num_vertices)");
+	}
+	if(out.ndim() != 2 || out.shape(0) != syndromes.shape(0)
+	   || static_cast<size_t>(out.shape(1)) != batch_decoder.num_edges())
+	{
+		throw std::invalid_argument(
+			"out must be a 2D array of shape (num_shots, num_edges)");
+	}
+	check_output_array(out);
+
+	const auto arr = as_integer_array(syndromes);
+	visit_integer_dtype(
+		arr.dtype(),
+		[&]<typename T>(T /*tag*/)
+		{
+			const auto in_data = std::span<const T>(static_cast<const T*>(arr.data()),
+													static_cast<size_t>(arr.size()));
+			visit_integer_dtype(
+				out.dtype(),
+				[&]<typename U>(U /*tag*/)
 				{
-					throw std::invalid_argument(
-						"Number of partiy operators must be larger than 0");
-				}
-				if(num_qubits <= 0)
+					auto out_data = std::span<U>(static_cast<U*>(out.mutable_data()),
+												 static_cast<size_t>(out.size()));
+					const py::gil_scoped_release release;
+					batch_decoder.decode_batch(in_data, out_data);
+				});
+		});
+}
+
+/**
+ * @brief Decode a 2D array of syndromes of shape (num_shots, num_vertices) and call
+ * write_row(shot, qubits) with the sorted indices of the qubits to correct in each
+ * shot (see to_qubits).
+ *
+ * Shots are decoded by the threads of batch_decoder with the GIL released, and
+ * write_row is called from these threads.
+ */
+template<class BatchDecoder, typename WriteRow>
+void decode_batch_qubits(BatchDecoder& batch_decoder, const py::array& syndromes,
+						 WriteRow&& write_row)
+{
+	if(syndromes.ndim() != 2
+	   || static_cast<size_t>(syndromes.shape(1)) != batch_decoder.num_vertices())
+	{
+		throw std::invalid_argument(
+			"syndromes must be a 2D array of shape (num_shots, num_vertices)");
+	}
+
+	const auto arr = as_integer_array(syndromes);
+	visit_integer_dtype(
+		arr.dtype(),
+		[&]<typename T>(T /*tag*/)
+		{
+			const auto data = std::span<const T>(static_cast<const T*>(arr.data()),
+												 static_cast<size_t>(arr.size()));
+			const py::gil_scoped_release release;
+			batch_decoder.decode_batch_edges(
+				data,
+				[&](size_t shot, std::vector<uint32_t>& edge_indices)
 				{
-					throw std::invalid_argument("Number of qubits must be larger than 0");
-				}
-				if(repetitions <= 1)
+					to_qubits(batch_decoder.lattice(), edge_indices);
+					write_row(shot, std::span<const uint32_t>(edge_indices));
+				});
+		});
+}
+
+/**
+ * @brief Register the methods shared by decoders of all lattice types saved to files
+ */
+template<class Lattice>
+auto bind_decoder(py::module_& m, const char* name)
+	-> py::class_<UnionFindCPP::Decoder<Lattice>>
+{
+	using UnionFindDecoder = UnionFindCPP::Decoder<Lattice>;
+	py::class_<UnionFindDecoder> cls(
+		m, name,
+		"Union-Find decoder. The GIL is released while decoding, but an instance keeps "
+		"its decoding state between calls and must not be used from several Python "
+		"threads at the same time. Use one decoder per thread, or a batch decoder to "
+		"decode many shots in parallel.");
+	cls.def_static(
+		   "load",
+		   [](const std::string& path)
+		   {
+			   return UnionFindDecoder(
+				   std::make_shared<const Lattice>(Lattice::load(path)));
+		   },
+		   py::arg("path"),
+		   "Create a decoder from a lattice file written by save. The file is mapped "
+		   "read-only, so processes loading the same file share its memory.")
+		.def(
+			"save",
+			[](const UnionFindDecoder& decoder, const std::string& path)
+			{ decoder.lattice().save(path); },
+			py::arg("path"), "Save the lattice of the decoder to a binary file")
+		.def_property_readonly(
+			"repetitions",
+			[](const UnionFindDecoder& decoder)
+			{ return decoder.lattice().repetitions(); },
+			"Number of repeated measurements the lattice was built with")
+		.def("clear", &UnionFindDecoder::clear, "Clear decoder's internal data")
+		.def_property("growth_policy", &UnionFindDecoder::growth_policy,
+					  &UnionFindDecoder::set_growth_policy,
+					  "Order in which odd clusters are grown")
+		.def_property_readonly("num_edges", &UnionFindDecoder::num_edges,
+							   "Get total number of edges (qubits) of the decoder")
+		.def_property_readonly(
+			"num_vertices", &UnionFindDecoder::num_vertices,
+			"Get total number of vertices (parity operators) of the decoder")
+		.def(
+			"decode",
+			[](UnionFindDecoder& decoder, const py::array& syndromes,
+			   std::optional<py::array> out) -> py::array
+			{
+				py::array res = out ? *out
+									: py::array_t<uint32_t>(
+										static_cast<py::ssize_t>(decoder.num_edges()));
+				decode_array(decoder, syndromes, res);
+				return res;
+			},
+			py::arg("syndromes"), py::arg("out") = py::none(),
+			"Decode the given syndromes and return a 0/1 array over the edges (qubits). "
+			"Boolean or integer C-contiguous arrays are read without a copy. If out is "
+			"given, corrections are written into it. The GIL is released while decoding, "
+			"so different decoder objects can be used from different Python threads, "
+			"but the same object must not be used by two threads at once.")
+		.def(
+			"decode_defects",
+			[](UnionFindDecoder& decoder, const py::array& defects)
+			{
+				const auto arr = as_defects_array(decoder, defects);
+				const auto data = std::span<const uint32_t>(
+					arr.data(), static_cast<size_t>(arr.size()));
+
+				std::vector<uint32_t> qubits;
 				{
-					throw std::invalid_argument("Repetitions must be larger than 1");
+					const py::gil_scoped_release release;
+					decoder.decode_defects(data, qubits);
+					to_qubits(decoder.lattice(), qubits);
 				}
-				// check the given dimension is correct
-				return UnionFindFromParity(static_cast<uint32_t>(num_parities),
-										   static_cast<uint32_t>(num_qubits),
-										   static_cast<int*>(col_indices.request().ptr),
-										   static_cast<int*>(indptr.request().ptr),
-										   static_cast<uint32_t>(repetitions));
-			}))
-		.def("clear", &UnionFindFromParity::clear, "Clear decoder's internal data")
-		.def_property_readonly("num_edges", &UnionFindFromParity::num_edges,
+				auto res = py::array_t<int64_t>(static_cast<py::ssize_t>(qubits.size()));
+				std::copy(qubits.begin(), qubits.end(), res.mutable_data());
+				return res;
+			},
+			py::arg("defects"),
+			"Decode syndromes given as the distinct indices of the vertices with defects "
+			"and return the sorted indices of the qubits to correct as an int64 array, "
+			"as decode_qubits does. The cost does not depend on the size of the lattice "
+			"apart from the clusters.")
+		.def(
+			"set_observables",
+			[](UnionFindDecoder& decoder, int num_observables, const py::array& indptr,
+			   const py::array& indices)
+			{
+				decoder.set_observables(make_observables(
+					num_observables, decoder.num_edges(), indptr, indices));
+			},
+			py::arg("num_observables"), py::arg("indptr"), py::arg("indices"),
+			"Set the logical observables as a matrix of shape (num_observables, "
+			"num_edges) in CSR format. At most 64 observables are supported.")
+		.def("decode_observables", &decode_observables_array<UnionFindDecoder>,
+			 py::arg("syndromes"),
+			 "Decode the given syndromes and return the logical observables flipped by "
+			 "the correction as an integer whose bit k corresponds to observable k.")
+		.def(
+			"decode_qubits",
+			[](UnionFindDecoder& decoder, const py::array& syndromes)
+			{
+				std::vector<uint32_t> qubits;
+				decode_qubits_array(decoder, syndromes, qubits);
+				auto res = py::array_t<int64_t>(static_cast<py::ssize_t>(qubits.size()));
+				std::copy(qubits.begin(), qubits.end(), res.mutable_data());
+				return res;
+			},
+			py::arg("syndromes"),
+			"Decode the given syndromes and return the sorted indices of the qubits to "
+			"correct as an int64 array. For a repeated lattice, these are the qubits of "
+			"a layer flipped in an odd number of layers.")
+		.def(
+			"decode_packed",
+			[](UnionFindDecoder& decoder, const py::array& syndromes)
+			{
+				std::vector<uint32_t> qubits;
+				decode_qubits_array(decoder, syndromes, qubits);
+				auto res = py::array_t<uint8_t>(static_cast<py::ssize_t>(
+					packed_size(num_qubits(decoder.lattice()))));
+				pack_qubits(qubits, std::span<uint8_t>(res.mutable_data(),
+													   static_cast<size_t>(res.size())));
+				return res;
+			},
+			py::arg("syndromes"),
+			"Decode the given syndromes and return the qubits to correct as bits packed "
+			"in a uint8 array as numpy.packbits does. Qubits are the same as those of "
+			"decode_qubits.");
+	return cls;
+}
+
+/**
+ * @brief Register a batch decoder sharing the lattice of a Decoder<Lattice>
+ */
+template<class Lattice>
+auto bind_batch_decoder(py::module_& m, const char* name)
+	-> py::class_<UnionFindCPP::BatchDecoder<Lattice>>
+{
+	using UnionFindDecoder = UnionFindCPP::Decoder<Lattice>;
+	using BatchUnionFindDecoder = UnionFindCPP::BatchDecoder<Lattice>;
+	return py::class_<BatchUnionFindDecoder>(m, name)
+		.def(py::init(
+				 [](const UnionFindDecoder& decoder, int num_threads)
+				 {
+					 if(num_threads < 0)
+					 {
+						 throw std::invalid_argument(
+							 "Number of threads must be larger than or equal to 0");
+					 }
+					 auto res = std::make_unique<BatchUnionFindDecoder>(
+						 static_cast<size_t>(num_threads), decoder.lattice_ptr());
+					 res->set_observables(decoder.observables_ptr());
+					 return res;
+				 }),
+			 py::arg("decoder"), py::arg("num_threads") = 0,
+			 "Create a batch decoder sharing the lattice and the logical observables of "
+			 "the given decoder. If num_threads is 0, the number of hardware threads is "
+			 "used.")
+		.def_property_readonly("num_threads", &BatchUnionFindDecoder::num_threads,
+							   "Get the number of threads used for decoding")
+		.def("set_growth_policy", &BatchUnionFindDecoder::set_growth_policy,
+			 "Set the order in which odd clusters are grown")
+		.def_property_readonly("num_edges", &BatchUnionFindDecoder::num_edges,
 							   "Get total number of edges (qubits) of the decoder")
 		.def_property_readonly(
-			"num_vertices", &UnionFindFromParity::num_vertices,
+			"num_vertices", &BatchUnionFindDecoder::num_vertices,
 			"Get total number of vertices (parity operators) of the decoder")
 		.def(
-			"decode",
-			[](UnionFindFromParity& decoder,
-			   std::vector<uint32_t> syndromes) -> py::array_t<uint32_t>
+			"decode_batch",
+			[](BatchUnionFindDecoder& batch_decoder, const py::array& syndromes,
+			   std::optional<py::array> out) -> py::array
 			{
-				if(decoder.num_vertices() != syndromes.size())
+				py::array res
+					= out ? *out
+						  : py::array_t<uint8_t>(std::vector<py::ssize_t>{
+							  syndromes.ndim() > 0 ? syndromes.shape(0) : 0,
+							  static_cast<py::ssize_t>(batch_decoder.num_edges())});
+				decode_batch_array(batch_decoder, syndromes, res);
+				return res;
+			},
+			py::arg("syndromes"), py::arg("out") = py::none(),
+			"Decode a 2D array of syndromes of shape (num_shots, num_vertices) and "
+			"return a 0/1 array of shape (num_shots, num_edges). The GIL is released "
+			"while decoding.")
+		.def(
+			"decode_batch_observables",
+			[](BatchUnionFindDecoder& batch_decoder, const py::array& syndromes)
+			{
+				if(syndromes.ndim() != 2
+				   || static_cast<size_t>(syndromes.shape(1))
+						  != batch_decoder.num_vertices())
 				{
-					throw std::invalid_argument("Size of syndromes should be the same as "
-												"the size of vertices");
+					throw std::invalid_argument("syndromes must be a 2D array of shape "
+												"(num_shots, num_vertices)");
 				}
-				auto res = decoder.decode(syndromes);
+				const auto arr = as_integer_array(syndromes);
+				auto res = py::array_t<uint64_t>(syndromes.shape(0));
+				auto out = std::span<uint64_t>(res.mutable_data(),
+											   static_cast<size_t>(res.size()));
+				visit_integer_dtype(
+					arr.dtype(),
+					[&]<typename T>(T /*tag*/)
+					{
+						const auto data = std::span<const T>(
+							static_cast<const T*>(arr.data()),
+							static_cast<size_t>(arr.size()));
+						const py::gil_scoped_release release;
+						batch_decoder.decode_batch_observables(data, out);
+					});
+				return res;
+			},
+			py::arg("syndromes"),
+			"Decode a 2D array of syndromes of shape (num_shots, num_vertices) and "
+			"return the logical observables flipped in each shot as a uint64 bitmask. "
+			"The GIL is released while decoding.")
+		.def(
+			"decode_batch_packed",
+			[](BatchUnionFindDecoder& batch_decoder, const py::array& syndromes)
+			{
+				const size_t row_size
+					= packed_size(num_qubits(batch_decoder.lattice()));
+				auto res = py::array_t<uint8_t>(std::vector<py::ssize_t>{
+					syndromes.ndim() > 0 ? syndromes.shape(0) : 0,
+					static_cast<py::ssize_t>(row_size)});
+				auto* const out = res.mutable_data();
+				decode_batch_qubits(
+					batch_decoder, syndromes,
+					[&](size_t shot, std::span<const uint32_t> qubits)
+					{
+						pack_qubits(qubits,
+									std::span<uint8_t>(out + shot * row_size, row_size));
+					});
+				return res;
+			},
+			py::arg("syndromes"),
+			"Decode a 2D array of syndromes of shape (num_shots, num_vertices) and "
+			"return the qubits to correct in each shot as bits packed in a uint8 array "
+			"as numpy.packbits does along the last axis. The GIL is released while "
+			"decoding.");
+}
+} // namespace
 
-				uint32_t* corrections = new uint32_t[decoder.num_edges()];
-				memset(corrections, 0, sizeof(uint32_t) * decoder.num_edges());
-				for(size_t i = 0; i < res.size(); ++i)
+// NOLINTNEXTLINE(cppcoreguidelines-*)
+PYBIND11_MODULE(_union_find_py, m)
+{
+	py::enum_<UnionFindCPP::GrowthPolicy>(m, "GrowthPolicy")
+		.value("AllOddClusters", UnionFindCPP::GrowthPolicy::AllOddClusters)
+		.value("SmallestFirst", UnionFindCPP::GrowthPolicy::SmallestFirst);
+
+	py::enum_<UnionFindCPP::VertexOrder>(m, "VertexOrder")
+		.value("Original", UnionFindCPP::VertexOrder::Original)
+		.value("BreadthFirst", UnionFindCPP::VertexOrder::BreadthFirst)
+		.value("ReverseCuthillMcKee", UnionFindCPP::VertexOrder::ReverseCuthillMcKee);
+
+	using UnionFindCPP::LatticeFromParity, UnionFindCPP::VertexOrder;
+	using UnionFindFromParity = UnionFindCPP::Decoder<LatticeFromParity>;
+	bind_decoder<LatticeFromParity>(m, "DecoderFromParity")
+		.def(py::init(
+				 [](int num_parities, int num_qubits, const py::array& col_indices,
+					const py::array& indptr, VertexOrder vertex_order)
+				 {
+					 return visit_parity_matrix(
+						 num_parities, num_qubits, col_indices, indptr,
+						 [&](const auto* col_indices_ptr, const auto* indptr_ptr)
+						 {
+							 return UnionFindFromParity(
+								 LatticeFromParity(static_cast<uint32_t>(num_parities),
+												   static_cast<uint32_t>(num_qubits),
+												   col_indices_ptr, indptr_ptr)
+									 .reordered(vertex_order));
+						 });
+				 }),
+			 py::arg("num_parities"), py::arg("num_qubits"), py::arg("col_indices"),
+			 py::arg("indptr"), py::arg("vertex_order") = VertexOrder::Original)
+		.def(py::init(
+				 [](int num_parities, int num_qubits, const py::array& col_indices,
+					const py::array& indptr, int repetitions, VertexOrder vertex_order)
+				 {
+					 if(repetitions <= 1)
+					 {
+						 throw std::invalid_argument("Repetitions must be larger than 1");
+					 }
+					 return visit_parity_matrix(
+						 num_parities, num_qubits, col_indices, indptr,
+						 [&](const auto* col_indices_ptr, const auto* indptr_ptr)
+						 {
+							 return UnionFindFromParity(
+								 LatticeFromParity(static_cast<uint32_t>(num_parities),
+												   static_cast<uint32_t>(num_qubits),
+												   col_indices_ptr, indptr_ptr,
+												   static_cast<uint32_t>(repetitions))
+									 .reordered(vertex_order));
+						 });
+				 }),
+			 py::arg("num_parities"), py::arg("num_qubits"), py::arg("col_indices"),
+			 py::arg("indptr"), py::arg("repetitions"),
+			 py::arg("vertex_order") = VertexOrder::Original);
+
+	using UnionFindRepeated = UnionFindCPP::Decoder<UnionFindCPP::LatticeRepeated>;
+	bind_decoder<UnionFindCPP::LatticeRepeated>(m, "RepeatedDecoderFromParity")
+		.def(py::init(
+				 [](int num_parities, int num_qubits, const py::array& col_indices,
+					const py::array& indptr, int repetitions, VertexOrder vertex_order)
+				 {
+					 if(repetitions <= 1)
+					 {
+						 throw std::invalid_argument("Repetitions must be larger than 1");
+					 }
+					 // only a single layer of the lattice is stored
+					 return visit_parity_matrix(
+						 num_parities, num_qubits, col_indices, indptr,
+						 [&](const auto* col_indices_ptr, const auto* indptr_ptr)
+						 {
+							 return UnionFindRepeated(
+								 LatticeFromParity(static_cast<uint32_t>(num_parities),
+												   static_cast<uint32_t>(num_qubits),
+												   col_indices_ptr, indptr_ptr)
+									 .reordered(vertex_order),
+								 static_cast<uint32_t>(repetitions));
+						 });
+				 }),
+			 py::arg("num_parities"), py::arg("num_qubits"), py::arg("col_indices"),
+			 py::arg("indptr"), py::arg("repetitions"),
+			 py::arg("vertex_order") = VertexOrder::Original)
+		.def_property_readonly(
+			"layer_num_vertices",
+			[](const UnionFindRepeated& decoder)
+			{ return decoder.lattice().layer().num_vertices(); },
+			"Number of vertices (parity operators) of a layer")
+		.def_property_readonly(
+			"layer_num_edges",
+			[](const UnionFindRepeated& decoder)
+			{ return decoder.lattice().layer().num_edges(); },
+			"Number of spacelike edges (qubits) of a layer");
+
+	bind_batch_decoder<UnionFindCPP::LatticeFromParity>(m, "BatchDecoderFromParity");
+	using BatchUnionFindRepeated
+		= UnionFindCPP::BatchDecoder<UnionFindCPP::LatticeRepeated>;
+	bind_batch_decoder<UnionFindCPP::LatticeRepeated>(m, "BatchRepeatedDecoderFromParity")
+		.def(
+			"decode_batch_folded",
+			[](BatchUnionFindRepeated& batch_decoder, const py::array& syndromes,
+			   std::optional<py::array> out) -> py::array
+			{
+				const size_t row_size = batch_decoder.lattice().layer().num_edges();
+				py::array res
+					= out ? *out
+						  : py::array_t<uint8_t>(std::vector<py::ssize_t>{
+							  syndromes.ndim() > 0 ? syndromes.shape(0) : 0,
+							  static_cast<py::ssize_t>(row_size)});
+				if(res.ndim() != 2
+				   || (syndromes.ndim() > 0 && res.shape(0) != syndromes.shape(0))
+				   || static_cast<size_t>(res.shape(1)) != row_size)
 				{
-					corrections[decoder.edge_idx(res[i])] = 1;
+					throw std::invalid_argument(
+						"out must be a 2D array of shape (num_shots, layer_num_edges)");
 				}
-				py::capsule free_when_done(corrections, free_arr_uint32);
+				check_output_array(res);
 
-				return py::array_t<uint32_t>({(int64_t)decoder.num_edges()}, corrections,
-											 free_when_done);
+				visit_integer_dtype(
+					res.dtype(),
+					[&]<typename U>(U /*tag*/)
+					{
+						auto* const out_data = static_cast<U*>(res.mutable_data());
+						decode_batch_qubits(
+							batch_decoder, syndromes,
+							[&](size_t shot, std::span<const uint32_t> qubits)
+							{
+								auto* const row = out_data + shot * row_size;
+								std::fill(row, row + row_size, U{0});
+								for(const auto qubit : qubits) { row[qubit] = U{1}; }
+							});
+					});
+				return res;
 			},
-			"Decode the given syndroms");
+			py::arg("syndromes"), py::arg("out") = py::none(),
+			"Decode a 2D array of syndromes of shape (num_shots, num_vertices) and "
+			"return a 0/1 array of shape (num_shots, layer_num_edges) whose element is 1 "
+			"if the qubit is flipped in an odd number of layers. The layers are folded "
+			"while decoding, so no array over all edges is allocated.");
 }
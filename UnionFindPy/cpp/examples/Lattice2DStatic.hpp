@@ -0,0 +1,124 @@
+// Copyright (C) 2021 UnionFind++ authors
+//
+// This file is part of UnionFind++.
+//
+// UnionFind++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UnionFind++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UnionFind++.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+#include "toric_utils.hpp"
+#include "utility.hpp"
+
+#include <array>
+#include <span>
+#include <stdexcept>
+
+namespace UnionFindCPP
+{
+/**
+ * @brief Same lattice as Lattice2D, but with L fixed at compile time.
+ *
+ * Divisions and remainders by L become constant operations (shifts and masks when L is
+ * a power of two), and the neighbors of all vertices together with the edge indices
+ * are in a constexpr table. Vertex and edge indices are the same as Lattice2D.
+ */
+template<uint32_t L> class Lattice2DStatic
+{
+public:
+	using Vertex = uint32_t;
+
+private:
+	using NeighborTable = std::array<std::array<Neighbor, 4>, L * L>;
+
+	constexpr static auto make_neighbor_table() -> NeighborTable
+	{
+		NeighborTable table{};
+		for(Vertex v = 0; v < L * L; ++v)
+		{
+			const uint32_t row = v / L;
+			const uint32_t col = v % L;
+			const std::array<Vertex, 4> neighbors{
+				to_vertex_index(L, row - 1, col),
+				to_vertex_index(L, row + 1, col),
+				to_vertex_index(L, row, col - 1),
+				to_vertex_index(L, row, col + 1),
+			};
+			for(uint32_t idx = 0; idx < 4; ++idx)
+			{
+				const Vertex u = neighbors[idx];
+				table[v][idx] = Neighbor{u, to_edge_idx(L, Edge{v, u})};
+			}
+		}
+		return table;
+	}
+
+	constexpr static auto neighbor_table_ = make_neighbor_table();
+
+public:
+	constexpr Lattice2DStatic() = default;
+
+	/**
+	 * @brief Same signature as the constructor of Lattice2D. L must be the template
+	 * parameter.
+	 */
+	explicit Lattice2DStatic(uint32_t L_runtime)
+	{
+		if(L_runtime != L)
+		{
+			throw std::invalid_argument("L must be the same as the template parameter");
+		}
+	}
+
+	[[nodiscard]] constexpr static auto getL() -> uint32_t { return L; }
+
+	[[nodiscard]] constexpr static auto vertex_connection_count(Vertex /*v*/) -> uint32_t
+	{
+		return 4;
+	}
+
+	[[nodiscard]] constexpr static auto vertex_neighbors(Vertex v)
+		-> std::span<const Neighbor>
+	{
+		return neighbor_table_[v];
+	}
+
+	[[nodiscard]] constexpr static auto vertex_connections(Vertex v)
+		-> std::array<Vertex, 4>
+	{
+		const auto& neighbors = neighbor_table_[v];
+		return {neighbors[0].vertex, neighbors[1].vertex, neighbors[2].vertex,
+				neighbors[3].vertex};
+	}
+
+	[[nodiscard]] constexpr static auto num_vertices() -> uint32_t { return L * L; }
+
+	[[nodiscard]] constexpr static auto num_edges() -> uint32_t { return 2 * L * L; }
+
+	[[nodiscard]] constexpr static auto edge_idx(const Edge& edge) -> uint32_t
+	{
+		return to_edge_idx(L, edge);
+	}
+
+	[[nodiscard]] constexpr static auto to_edge(uint32_t edge_index) -> Edge
+	{
+		const uint32_t row = edge_index / L; // % L is done in to_vertex_index
+		const uint32_t col = edge_index % L;
+		if((edge_index / (L * L)) == 0) // vertical edge
+		{
+			return Edge(to_vertex_index(L, row, col), to_vertex_index(L, row - 1, col));
+		}
+		// horizontal edge
+		return Edge(to_vertex_index(L, row, col), to_vertex_index(L, row, col + 1));
+	}
+};
+} // namespace UnionFindCPP
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "Lattice2D.hpp"
+#include "StaticVector.hpp"
 #include "toric_utils.hpp"
 #include "utility.hpp"
 
@@ -35,6 +36,8 @@ private:
 
 public:
 	using Vertex = uint32_t;
+	/* at most six neighbors, stored without heap allocation */
+	using Connections = StaticVector<Vertex, 6>; // NOLINT(readability-magic-numbers)
 
 	explicit LatticeCubic(uint32_t L) : L_{L} { }
 
@@ -54,7 +57,7 @@ public:
 		return 6; // NOLINT(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
 	}
 
-	[[nodiscard]] auto vertex_connections(Vertex v) const -> std::vector<Vertex>
+	[[nodiscard]] auto vertex_connections(Vertex v) const -> Connections
 	{
 		uint32_t L = L_;
 
@@ -62,7 +65,7 @@ public:
 		uint32_t row = (v / L) % L;
 		uint32_t col = v % L;
 
-		auto res = std::vector<Vertex>{
+		auto res = Connections{
 			to_vertex_index(row - 1, col, h),
 			to_vertex_index(row + 1, col, h),
 			to_vertex_index(row, col - 1, h),
@@ -0,0 +1,161 @@
+// Copyright (C) 2021 UnionFind++ authors
+//
+// This file is part of UnionFind++.
+//
+// UnionFind++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UnionFind++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UnionFind++.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+#include "Lattice2DStatic.hpp"
+#include "StaticVector.hpp"
+#include "toric_utils.hpp"
+#include "utility.hpp"
+
+#include <array>
+#include <span>
+#include <stdexcept>
+
+namespace UnionFindCPP
+{
+namespace detail
+{
+	template<uint32_t L>
+	constexpr auto cubic_vertex_index(uint32_t row, uint32_t col, uint32_t h) -> uint32_t
+	{
+		return to_vertex_index(L, row, col) + h * (L * L);
+	}
+
+	template<uint32_t L> constexpr auto cubic_edge_idx(const Edge& edge) -> uint32_t
+	{
+		const uint32_t uh = edge.u / (L * L);
+
+		if((edge.u / (L * L)) == (edge.v / (L * L))) // edge is spacelike
+		{
+			return to_edge_idx(L, Edge{edge.u % (L * L), edge.v % (L * L)})
+				   + 3 * L * L * uh;
+		}
+		// edge is timelike
+		const uint32_t row = (edge.u / L) % L;
+		const uint32_t col = edge.u % L;
+		return 3 * L * L * uh + 2 * L * L + L * row + col;
+	}
+
+	/**
+	 * @brief Neighbors of each vertex of LatticeCubic with the connecting edge indices,
+	 * in the same order as LatticeCubic::vertex_connections
+	 */
+	template<uint32_t L>
+	constexpr auto make_cubic_neighbor_table()
+		-> std::array<StaticVector<Neighbor, 6>, L * L * L>
+	{
+		std::array<StaticVector<Neighbor, 6>, L * L * L> table{};
+		for(uint32_t v = 0; v < L * L * L; ++v)
+		{
+			const uint32_t h = v / (L * L);
+			const uint32_t row = (v / L) % L;
+			const uint32_t col = v % L;
+
+			StaticVector<uint32_t, 6> neighbors{
+				cubic_vertex_index<L>(row - 1, col, h),
+				cubic_vertex_index<L>(row + 1, col, h),
+				cubic_vertex_index<L>(row, col - 1, h),
+				cubic_vertex_index<L>(row, col + 1, h),
+			};
+			if(h < L - 1) { neighbors.push_back(cubic_vertex_index<L>(row, col, h + 1)); }
+			if(h > 0) { neighbors.push_back(cubic_vertex_index<L>(row, col, h - 1)); }
+
+			for(const auto u : neighbors)
+			{
+				table[v].push_back(Neighbor{u, cubic_edge_idx<L>(Edge{v, u})});
+			}
+		}
+		return table;
+	}
+} // namespace detail
+
+/**
+ * @brief Same lattice as LatticeCubic, but with L fixed at compile time.
+ *
+ * See Lattice2DStatic. Vertex and edge indices are the same as LatticeCubic.
+ */
+template<uint32_t L> class LatticeCubicStatic
+{
+public:
+	using Vertex = uint32_t;
+	using Connections = StaticVector<Vertex, 6>; // NOLINT(readability-magic-numbers)
+
+private:
+	constexpr static auto neighbor_table_ = detail::make_cubic_neighbor_table<L>();
+
+public:
+	constexpr LatticeCubicStatic() = default;
+
+	/**
+	 * @brief Same signature as the constructor of LatticeCubic. L must be the template
+	 * parameter.
+	 */
+	explicit LatticeCubicStatic(uint32_t L_runtime)
+	{
+		if(L_runtime != L)
+		{
+			throw std::invalid_argument("L must be the same as the template parameter");
+		}
+	}
+
+	[[nodiscard]] constexpr static auto getL() -> uint32_t { return L; }
+
+	[[nodiscard]] constexpr static auto vertex_connection_count(Vertex v) -> uint32_t
+	{
+		return neighbor_table_[v].size();
+	}
+
+	[[nodiscard]] constexpr static auto vertex_neighbors(Vertex v)
+		-> std::span<const Neighbor>
+	{
+		return {neighbor_table_[v].data(), neighbor_table_[v].size()};
+	}
+
+	[[nodiscard]] constexpr static auto vertex_connections(Vertex v) -> Connections
+	{
+		Connections res;
+		for(const auto& neighbor : neighbor_table_[v]) { res.push_back(neighbor.vertex); }
+		return res;
+	}
+
+	[[nodiscard]] constexpr static auto num_vertices() -> uint32_t { return L * L * L; }
+
+	[[nodiscard]] constexpr static auto num_edges() -> uint32_t
+	{
+		return 3 * L * L * L - L * L;
+	}
+
+	[[nodiscard]] constexpr static auto edge_idx(const Edge& edge) -> uint32_t
+	{
+		return detail::cubic_edge_idx<L>(edge);
+	}
+
+	[[nodiscard]] constexpr static auto to_edge(uint32_t edge_index) -> Edge
+	{
+		const uint32_t h = edge_index / (3 * L * L);
+		const uint32_t layer_idx = edge_index % (3 * L * L);
+		if(layer_idx >= 2 * L * L) // edge is in the time direction
+		{
+			const auto [row, col] = vertex_to_coord(L, layer_idx - 2 * L * L);
+			return Edge{detail::cubic_vertex_index<L>(row, col, h),
+						detail::cubic_vertex_index<L>(row, col, h + 1)};
+		}
+		const Edge e_2d = Lattice2DStatic<L>::to_edge(layer_idx);
+		return Edge{e_2d.u + h * L * L, e_2d.v + h * L * L};
+	}
+};
+} // namespace UnionFindCPP
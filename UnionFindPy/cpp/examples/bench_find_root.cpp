@@ -0,0 +1,81 @@
+// Copyright (C) 2021 UnionFind++ authors
+//
+// This file is part of UnionFind++.
+//
+// UnionFind++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UnionFind++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UnionFind++.  If not, see <https://www.gnu.org/licenses/>.
+#include "Decoder.hpp"
+#include "FindRootPolicy.hpp"
+#include "Lattice2D.hpp"
+#include "LatticeCubic.hpp"
+#include "bench_utils.hpp"
+#include "runner_utils.hpp"
+
+#include <fmt/core.h>
+
+#include <iostream>
+#include <string_view>
+
+/**
+ * Compare path compression strategies of Decoder::find_root.
+ * Usage: bench_find_root L p
+ */
+
+namespace
+{
+constexpr uint32_t n_iter = 10'000;
+constexpr uint32_t seed = 1337;
+
+template<class Lattice, class FindRootPolicy>
+void run_bench(std::string_view lattice_name, std::string_view policy_name,
+			   const uint32_t L, const double p)
+{
+	using UnionFindCPP::Decoder, UnionFindCPP::DenseRootManager;
+	const Lattice lattice(L);
+	Decoder<Lattice, DenseRootManager, FindRootPolicy> decoder(L);
+
+	const auto [avg, q99] = UnionFindCPP::summarize_times(
+		UnionFindCPP::decoding_times(decoder, lattice, p, n_iter, seed), 0.99);
+	fmt::print("{}\t{}\t{:.3f}\t{:.3f}\n", lattice_name, policy_name, avg, q99);
+}
+
+template<class Lattice>
+void run_all_policies(std::string_view lattice_name, const uint32_t L, const double p)
+{
+	run_bench<Lattice, UnionFindCPP::PathCompression>(lattice_name, "PathCompression", L,
+													  p);
+	run_bench<Lattice, UnionFindCPP::PathHalving>(lattice_name, "PathHalving", L, p);
+	run_bench<Lattice, UnionFindCPP::PathSplitting>(lattice_name, "PathSplitting", L, p);
+}
+} // namespace
+
+auto main(int argc, char* argv[]) -> int
+{
+	uint32_t L = 0;
+	double p = 0.0;
+	try
+	{
+		std::tie(L, p) = parse_args(argc, argv);
+	}
+	catch(std::exception& e)
+	{
+		std::cout << e.what() << std::endl;
+		return 1;
+	}
+
+	fmt::print("lattice\tpolicy\taverage_microseconds\tq99_microseconds\n");
+	run_all_policies<UnionFindCPP::Lattice2D>("Lattice2D", L, p);
+	run_all_policies<UnionFindCPP::LatticeCubic>("LatticeCubic", L, p);
+
+	return 0;
+}
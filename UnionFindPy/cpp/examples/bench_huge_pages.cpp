@@ -0,0 +1,184 @@
+// Copyright (C) 2021 UnionFind++ authors
+//
+// This file is part of UnionFind++.
+//
+// UnionFind++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UnionFind++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UnionFind++.  If not, see <https://www.gnu.org/licenses/>.
+#include "Decoder.hpp"
+#include "HugePageAllocator.hpp"
+#include "LatticeCubic.hpp"
+#include "error_utils.hpp"
+#include "runner_utils.hpp"
+
+#include <fmt/core.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Compare the decoding time and the number of dTLB load misses of decoders whose
+ * per-vertex and per-edge arrays use normal pages and huge pages.
+ * Usage: bench_huge_pages L p
+ *
+ * Misses are counted with perf_event_open, and are not available if the kernel does not
+ * allow it (see /proc/sys/kernel/perf_event_paranoid). Whether huge pages are used can be
+ * checked with AnonHugePages in /proc/meminfo.
+ */
+
+namespace
+{
+constexpr uint32_t n_iter = 200;
+constexpr uint32_t seed = 1337;
+
+/**
+ * @brief Counter of dTLB load misses of the calling thread
+ */
+class DtlbMissCounter
+{
+private:
+	int fd_ = -1;
+
+public:
+	DtlbMissCounter()
+	{
+#if defined(__linux__)
+		perf_event_attr attr{};
+		attr.type = PERF_TYPE_HW_CACHE;
+		attr.size = sizeof(perf_event_attr);
+		attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8U)
+					  | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16U);
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+		fd_ = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+	}
+
+	DtlbMissCounter(const DtlbMissCounter&) = delete;
+	DtlbMissCounter(DtlbMissCounter&&) = delete;
+	auto operator=(const DtlbMissCounter&) -> DtlbMissCounter& = delete;
+	auto operator=(DtlbMissCounter&&) -> DtlbMissCounter& = delete;
+
+	~DtlbMissCounter()
+	{
+#if defined(__linux__)
+		if(fd_ >= 0) { ::close(fd_); }
+#endif
+	}
+
+	void start() const
+	{
+#if defined(__linux__)
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+		if(fd_ >= 0) { ::ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0); }
+#endif
+	}
+
+	void stop() const
+	{
+#if defined(__linux__)
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+		if(fd_ >= 0) { ::ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0); }
+#endif
+	}
+
+	[[nodiscard]] auto count() const -> std::optional<uint64_t>
+	{
+#if defined(__linux__)
+		uint64_t value = 0;
+		if(fd_ >= 0 && ::read(fd_, &value, sizeof(value)) == sizeof(value))
+		{
+			return value;
+		}
+#endif
+		return std::nullopt;
+	}
+};
+
+void run_bench(std::string_view name, const uint32_t L, const double p,
+			   const bool huge_pages)
+{
+	using UnionFindCPP::Decoder, UnionFindCPP::LatticeCubic;
+	namespace chrono = std::chrono;
+
+	UnionFindCPP::set_huge_pages_enabled(huge_pages);
+	const LatticeCubic lattice(L);
+	Decoder<LatticeCubic> decoder(L);
+
+	std::mt19937_64 re{seed};
+	DtlbMissCounter counter;
+	double total_microseconds = 0.0;
+	std::vector<uint32_t> defects;
+	std::vector<uint32_t> corrections;
+
+	for(uint32_t k = 0; k < n_iter; ++k)
+	{
+		const auto syndromes = create_edge_error_syndromes(lattice, p, re);
+		defects.clear();
+		for(uint32_t v = 0; v < syndromes.size(); ++v)
+		{
+			if(syndromes[v] != 0) { defects.push_back(v); }
+		}
+
+		// only the growth of clusters is measured, not the scan of the syndromes
+		counter.start();
+		const auto start = chrono::high_resolution_clock::now();
+		decoder.decode_defects(defects, corrections);
+		const auto end = chrono::high_resolution_clock::now();
+		counter.stop();
+
+		total_microseconds += chrono::duration<double, std::micro>(end - start).count();
+	}
+
+	const auto misses = counter.count();
+	fmt::print("{}\t{:.3f}\t{}\n", name, total_microseconds / n_iter,
+			   misses ? fmt::format("{:.1f}", static_cast<double>(*misses) / n_iter)
+					  : std::string("n/a"));
+}
+} // namespace
+
+auto main(int argc, char* argv[]) -> int
+{
+	uint32_t L = 0;
+	double p = 0.0;
+	try
+	{
+		std::tie(L, p) = parse_args(argc, argv);
+	}
+	catch(std::exception& e)
+	{
+		std::cout << e.what() << std::endl;
+		return 1;
+	}
+
+	fmt::print("pages\taverage_microseconds\taverage_dtlb_load_misses\n");
+	run_bench("normal", L, p, false);
+	run_bench("huge", L, p, true);
+
+	return 0;
+}
@@ -0,0 +1,95 @@
+// Copyright (C) 2021 UnionFind++ authors
+//
+// This file is part of UnionFind++.
+//
+// UnionFind++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UnionFind++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UnionFind++.  If not, see <https://www.gnu.org/licenses/>.
+#include "LatticeFromParity.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Measure the time to construct LatticeFromParity from the parity matrix of the toric
+ * code, which has 2*L*L columns.
+ * Usage: bench_lattice_construction L [repetitions]
+ */
+
+namespace
+{
+constexpr int n_iter = 5;
+
+/**
+ * @brief Parity matrix of the X stabilizers of the toric code in CSR format
+ */
+auto toric_parity_matrix(const uint32_t L)
+	-> std::pair<std::vector<int>, std::vector<int>>
+{
+	std::vector<int> col_indices;
+	std::vector<int> indptr{0};
+	col_indices.reserve(size_t{4} * L * L);
+	indptr.reserve(size_t{L} * L + 1);
+	for(uint32_t row = 0; row < L; ++row)
+	{
+		for(uint32_t col = 0; col < L; ++col)
+		{
+			std::array<uint32_t, 4> qubits{row * L + col, row * L + (col + L - 1) % L,
+										   L * L + row * L + col,
+										   L * L + ((row + L - 1) % L) * L + col};
+			std::sort(qubits.begin(), qubits.end());
+			col_indices.insert(col_indices.end(), qubits.begin(), qubits.end());
+			indptr.push_back(static_cast<int>(col_indices.size()));
+		}
+	}
+	return {col_indices, indptr};
+}
+} // namespace
+
+auto main(int argc, char* argv[]) -> int
+{
+	using UnionFindCPP::LatticeFromParity;
+	if(argc != 2 && argc != 3)
+	{
+		std::cout << "Usage: " << argv[0] << " L [repetitions]" << std::endl;
+		return 1;
+	}
+	const auto L = static_cast<uint32_t>(std::stoul(argv[1]));
+	const auto repetitions = static_cast<uint32_t>(argc == 3 ? std::stoul(argv[2]) : 1);
+
+	const auto [col_indices, indptr] = toric_parity_matrix(L);
+	fmt::print("columns\trepetitions\tnum_threads\tmilliseconds\n");
+	const size_t hardware_threads = std::thread::hardware_concurrency();
+	for(const size_t num_threads : {size_t{1}, hardware_threads})
+	{
+		double total_ms = 0.0;
+		for(int iter = 0; iter < n_iter; ++iter)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			const auto lattice
+				= LatticeFromParity(L * L, 2 * L * L, col_indices.data(), indptr.data(),
+									repetitions, num_threads);
+			const auto end = std::chrono::steady_clock::now();
+			total_ms += std::chrono::duration<double, std::milli>(end - start).count();
+		}
+		fmt::print("{}\t{}\t{}\t{:.1f}\n", 2 * L * L, repetitions, num_threads,
+				   total_ms / n_iter);
+	}
+	return 0;
+}
@@ -0,0 +1,104 @@
+// Copyright (C) 2021 UnionFind++ authors
+//
+// This file is part of UnionFind++.
+//
+// UnionFind++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UnionFind++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UnionFind++.  If not, see <https://www.gnu.org/licenses/>.
+#include "Decoder.hpp"
+#include "Lattice2D.hpp"
+#include "Lattice2DStatic.hpp"
+#include "LatticeCubic.hpp"
+#include "LatticeCubicStatic.hpp"
+#include "bench_utils.hpp"
+#include "runner_utils.hpp"
+
+#include <fmt/core.h>
+
+#include <iostream>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Compare lattices with L given at runtime to those with L fixed at compile time.
+ * Usage: bench_static_lattice L p
+ * L must be one of static_lattice_sizes defined in runner_utils.hpp.
+ */
+
+namespace
+{
+constexpr uint32_t n_iter = 10'000;
+constexpr uint32_t seed = 1337;
+
+template<class Lattice, class RuntimeLattice>
+auto run_bench(const uint32_t L, const double p) -> std::pair<double, double>
+{
+	using UnionFindCPP::Decoder;
+	const RuntimeLattice lattice(L); // for generating errors
+	Decoder<Lattice> decoder(L);
+
+	return UnionFindCPP::summarize_times(
+		UnionFindCPP::decoding_times(decoder, lattice, p, n_iter, seed), 0.99);
+}
+
+/**
+ * @brief Print the decoding times for RuntimeLattice and StaticLattice<L>
+ */
+template<template<uint32_t> class StaticLattice, class RuntimeLattice>
+void compare(std::string_view lattice_name, const uint32_t L, const double p)
+{
+	const auto [avg, q99] = run_bench<RuntimeLattice, RuntimeLattice>(L, p);
+	fmt::print("{}\t{:.3f}\t{:.3f}\n", lattice_name, avg, q99);
+
+	dispatch_lattice<StaticLattice, RuntimeLattice>(
+		L,
+		[&]<class Lattice>()
+		{
+			if constexpr(std::is_same_v<Lattice, RuntimeLattice>)
+			{
+				fmt::print("{}Static\tL is not in static_lattice_sizes\n", lattice_name);
+			}
+			else
+			{
+				const auto [static_avg, static_q99]
+					= run_bench<Lattice, RuntimeLattice>(L, p);
+				fmt::print("{}Static\t{:.3f}\t{:.3f}\n", lattice_name, static_avg,
+						   static_q99);
+			}
+			return 0;
+		});
+}
+} // namespace
+
+auto main(int argc, char* argv[]) -> int
+{
+	using UnionFindCPP::Lattice2D, UnionFindCPP::Lattice2DStatic,
+		UnionFindCPP::LatticeCubic, UnionFindCPP::LatticeCubicStatic;
+	uint32_t L = 0;
+	double p = 0.0;
+	try
+	{
+		std::tie(L, p) = parse_args(argc, argv);
+	}
+	catch(std::exception& e)
+	{
+		std::cout << e.what() << std::endl;
+		return 1;
+	}
+
+	fmt::print("lattice\taverage_microseconds\tq99_microseconds\n");
+	compare<Lattice2DStatic, Lattice2D>("Lattice2D", L, p);
+	compare<LatticeCubicStatic, LatticeCubic>("LatticeCubic", L, p);
+
+	return 0;
+}
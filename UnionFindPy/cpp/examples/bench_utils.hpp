@@ -0,0 +1,78 @@
+// Copyright (C) 2021 UnionFind++ authors
+//
+// This file is part of UnionFind++.
+//
+// UnionFind++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UnionFind++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UnionFind++.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+#include "error_utils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/**
+ * This file contains helper functions for micro-benchmarks of decoders.
+ */
+
+namespace UnionFindCPP
+{
+/**
+ * @brief Decode n_iter random syndromes (each edge flipped with probability p) and
+ * return the decoding time of each shot in microseconds.
+ *
+ * Syndromes are generated from a random engine seeded with seed, so different decoders
+ * see the same sequence of syndromes. Only the decoding is timed.
+ */
+template<class Decoder, class Lattice>
+auto decoding_times(Decoder& decoder, const Lattice& lattice, const double p,
+					const uint32_t n_iter, const uint32_t seed) -> std::vector<double>
+{
+	namespace chrono = std::chrono;
+	std::mt19937_64 re{seed};
+	std::vector<double> times;
+	times.reserve(n_iter);
+
+	for(uint32_t k = 0; k < n_iter; ++k)
+	{
+		auto syndromes = create_edge_error_syndromes(lattice, p, re);
+
+		auto start = chrono::high_resolution_clock::now();
+		decoder.clear();
+		auto corrections = decoder.decode(syndromes);
+		auto end = chrono::high_resolution_clock::now();
+
+		times.emplace_back(
+			chrono::duration<double, std::micro>(end - start).count());
+	}
+	return times;
+}
+
+/**
+ * @brief Average and the given quantile of the decoding times
+ */
+inline auto summarize_times(std::vector<double> times, const double quantile)
+	-> std::pair<double, double>
+{
+	double sum = 0.0;
+	for(const auto t : times) { sum += t; }
+
+	const auto q_idx = static_cast<size_t>(quantile * static_cast<double>(times.size() - 1));
+	std::nth_element(times.begin(), times.begin() + q_idx, times.end());
+
+	return std::make_pair(sum / static_cast<double>(times.size()), times[q_idx]);
+}
+} // namespace UnionFindCPP
@@ -135,6 +135,27 @@ auto generate_errors(const uint32_t num_qubits, const uint32_t repetition, doubl
 	return std::make_pair(qubit_errors_x, qubit_errors_z);
 }
 
+/**
+ * @brief Flip each edge of the lattice independently with probability p and return the
+ * resulting syndromes. The lattice must provide to_edge(edge_index).
+ */
+template<class Lattice, class RandomEngine>
+auto create_edge_error_syndromes(const Lattice& lattice, const double p, RandomEngine& re)
+	-> std::vector<uint32_t>
+{
+	std::vector<uint32_t> syndromes(lattice.num_vertices(), 0U);
+	std::uniform_real_distribution<> urd(0.0, 1.0);
+
+	for(uint32_t edge_idx = 0; edge_idx < lattice.num_edges(); ++edge_idx)
+	{
+		if(!(urd(re) < p)) { continue; }
+		const Edge e = lattice.to_edge(edge_idx);
+		syndromes[e.u] ^= 1U;
+		syndromes[e.v] ^= 1U;
+	}
+	return syndromes;
+}
+
 void add_measurement_noise(uint32_t L, std::vector<uint32_t>& syndromes,
 						   const ArrayXXu& measurement_error);
 
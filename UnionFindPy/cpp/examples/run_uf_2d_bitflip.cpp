@@ -16,6 +16,7 @@
 // along with UnionFind++.  If not, see <https://www.gnu.org/licenses/>.
 #include "Decoder.hpp"
 #include "Lattice2D.hpp"
+#include "Lattice2DStatic.hpp"
 #include "LazyDecoder.hpp"
 #include "error_utils.hpp"
 #include "runner_utils.hpp"
@@ -32,50 +33,30 @@
 #include <iostream>
 #include <random>
 
-auto main(int argc, char* argv[]) -> int
+namespace
+{
+/**
+ * @brief Decode the shots assigned to this rank using Decoder<Lattice>. Returns the
+ * number of successful decodings and the total decoding time.
+ */
+template<class Lattice, class RandomEngine>
+auto run_decoding(const uint32_t L, const double p, const uint32_t n_iter,
+				  const int mpi_rank, const int mpi_size, RandomEngine& re)
+	-> std::pair<unsigned int, std::chrono::microseconds>
 {
 	namespace chrono = std::chrono;
-	using UnionFindCPP::Decoder, UnionFindCPP::ErrorType, UnionFindCPP::Lattice2D,
-		UnionFindCPP::LazyDecoder, UnionFindCPP::NoiseType;
+	using UnionFindCPP::Decoder, UnionFindCPP::ErrorType, UnionFindCPP::LazyDecoder,
+		UnionFindCPP::NoiseType;
 
 	const auto noise_type = NoiseType::X;
-	const uint32_t n_iter = 1'000'000;
-
-	int mpi_rank = 0;
-	int mpi_size = 1;
-
-#ifdef USE_MPI
-	MPI_Init(&argc, &argv);
-	MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
-	MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
-#endif
-
-	uint32_t L = 0;
-	double p = 0.0;
-	try
-	{
-		std::tie(L, p) = parse_args(argc, argv);
-	}
-	catch(std::exception& e)
-	{
-		std::cout << e.what() << std::endl;
-		return 1;
-	}
-
-	std::random_device rd;
-	std::default_random_engine re{rd()};
-
-#ifdef USE_MPI
-	fmt::print(stderr, "Processing at rank = {}, size = {}\n", mpi_rank, mpi_size);
-#endif
 
 	unsigned int n_success = 0U;
 	chrono::microseconds node_dur{};
 #ifdef USE_LAZY
-	LazyDecoder<Lattice2D> lazy_decoder(L);
+	LazyDecoder<Lattice> lazy_decoder(L);
 #endif
 
-	Decoder<Lattice2D> decoder(L);
+	Decoder<Lattice> decoder(L);
 	for(uint32_t k = mpi_rank; k < n_iter; k += mpi_size)
 	{
 		auto [x_errors, z_errors] = create_errors(re, decoder.num_edges(), p, noise_type);
@@ -106,6 +87,52 @@ auto main(int argc, char* argv[]) -> int
 		node_dur += dur;
 	}
 
+	return std::make_pair(n_success, node_dur);
+}
+} // namespace
+
+auto main(int argc, char* argv[]) -> int
+{
+	using UnionFindCPP::Lattice2D;
+
+	const uint32_t n_iter = 1'000'000;
+
+	int mpi_rank = 0;
+	int mpi_size = 1;
+
+#ifdef USE_MPI
+	MPI_Init(&argc, &argv);
+	MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+	MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+#endif
+
+	uint32_t L = 0;
+	double p = 0.0;
+	try
+	{
+		std::tie(L, p) = parse_args(argc, argv);
+	}
+	catch(std::exception& e)
+	{
+		std::cout << e.what() << std::endl;
+		return 1;
+	}
+
+	std::random_device rd;
+	std::default_random_engine re{rd()};
+
+#ifdef USE_MPI
+	fmt::print(stderr, "Processing at rank = {}, size = {}\n", mpi_rank, mpi_size);
+#endif
+
+	const auto [n_success, node_dur]
+		= dispatch_lattice<UnionFindCPP::Lattice2DStatic, Lattice2D>(
+			L,
+			[&]<class Lattice>()
+			{
+				return run_decoding<Lattice>(L, p, n_iter, mpi_rank, mpi_size, re);
+			});
+
 #ifdef USE_MPI
 	MPI_Barrier(MPI_COMM_WORLD);
 
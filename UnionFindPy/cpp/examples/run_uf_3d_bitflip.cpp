@@ -16,6 +16,7 @@
 // along with UnionFind++.  If not, see <https://www.gnu.org/licenses/>.
 #include "Decoder.hpp"
 #include "LatticeCubic.hpp"
+#include "LatticeCubicStatic.hpp"
 #include "LazyDecoder.hpp"
 #include "error_utils.hpp"
 #include "runner_utils.hpp"
@@ -33,52 +34,31 @@
 #include <iostream>
 #include <random>
 
-auto main(int argc, char* argv[]) -> int
+namespace
+{
+/**
+ * @brief Decode the shots assigned to this rank using Decoder<Lattice>. Returns the
+ * number of successful decodings and the total decoding time.
+ */
+template<class Lattice, class RandomEngine>
+auto run_decoding(const uint32_t L, const double p, const uint32_t n_iter,
+				  const int mpi_rank, const int mpi_size, RandomEngine& re)
+	-> std::pair<unsigned int, std::chrono::microseconds>
 {
 	namespace chrono = std::chrono;
 	using UnionFindCPP::ArrayXu, UnionFindCPP::Decoder, UnionFindCPP::ErrorType,
 		UnionFindCPP::LatticeCubic, UnionFindCPP::LazyDecoder, UnionFindCPP::NoiseType,
-		UnionFindCPP::add_measurement_noise, UnionFindCPP::add_corrections,
-		UnionFindCPP::layer_syndrome_diff;
+		UnionFindCPP::add_measurement_noise, UnionFindCPP::layer_syndrome_diff;
 
 	const auto noise_type = NoiseType::X;
-	const uint32_t n_iter = 1'000'000;
-
-	int mpi_rank = 0;
-	int mpi_size = 1;
-
-#ifdef USE_MPI
-	MPI_Init(&argc, &argv);
-	MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
-	MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
-#endif
-
-	uint32_t L = 0;
-	double p = 0.0;
-	try
-	{
-		std::tie(L, p) = parse_args(argc, argv);
-	}
-	catch(std::exception& e)
-	{
-		std::cout << e.what() << std::endl;
-		return 1;
-	}
-
-	std::random_device rd;
-	std::default_random_engine re{rd()};
-
-#ifdef USE_MPI
-	fmt::print(stderr, "Processing at rank = {}, size = {}\n", mpi_rank, mpi_size);
-#endif
 
 	unsigned int n_success = 0U;
 	chrono::microseconds node_dur{};
 #ifdef USE_LAZY
-	LazyDecoder<LatticeCubic> lazy_decoder(L);
+	LazyDecoder<Lattice> lazy_decoder(L);
 #endif
-	LatticeCubic lattice(L);
-	Decoder<LatticeCubic> decoder(L);
+	LatticeCubic lattice(L); // for computing syndromes
+	Decoder<Lattice> decoder(L);
 	for(uint32_t k = mpi_rank; k < n_iter; k += mpi_size)
 	{
 		auto [error_x, error_z] = generate_errors(2 * L * L, L, p, re, noise_type);
@@ -120,6 +100,52 @@ auto main(int argc, char* argv[]) -> int
 		node_dur += dur;
 	}
 
+	return std::make_pair(n_success, node_dur);
+}
+} // namespace
+
+auto main(int argc, char* argv[]) -> int
+{
+	using UnionFindCPP::LatticeCubic;
+
+	const uint32_t n_iter = 1'000'000;
+
+	int mpi_rank = 0;
+	int mpi_size = 1;
+
+#ifdef USE_MPI
+	MPI_Init(&argc, &argv);
+	MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+	MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+#endif
+
+	uint32_t L = 0;
+	double p = 0.0;
+	try
+	{
+		std::tie(L, p) = parse_args(argc, argv);
+	}
+	catch(std::exception& e)
+	{
+		std::cout << e.what() << std::endl;
+		return 1;
+	}
+
+	std::random_device rd;
+	std::default_random_engine re{rd()};
+
+#ifdef USE_MPI
+	fmt::print(stderr, "Processing at rank = {}, size = {}\n", mpi_rank, mpi_size);
+#endif
+
+	const auto [n_success, node_dur]
+		= dispatch_lattice<UnionFindCPP::LatticeCubicStatic, LatticeCubic>(
+			L,
+			[&]<class Lattice>()
+			{
+				return run_decoding<Lattice>(L, p, n_iter, mpi_rank, mpi_size, re);
+			});
+
 #ifdef USE_MPI
 	MPI_Barrier(MPI_COMM_WORLD);
 
@@ -17,9 +17,33 @@
 #pragma once
 
 #include <cstdint>
+#include <optional>
 #include <utility>
 
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,hicpp-avoid-c-arrays,modernize-avoid-c-arrays)
 auto parse_args(int argc, const char* const argv[]) -> std::pair<uint32_t, double>;
 void save_to_json(uint32_t L, double p, double avg_dur_in_microseconds,
 				  double avg_success);
+
+/* Code distances for which the runners use lattices with L fixed at compile time */
+using static_lattice_sizes
+	= std::integer_sequence<uint32_t, 5, 7, 9, 11, 13, 15, 17, 19, 21>;
+
+/**
+ * @brief Call func.template operator()<StaticLattice<L>>() if L is one of
+ * static_lattice_sizes, and func.template operator()<Lattice>() otherwise.
+ */
+template<template<uint32_t> class StaticLattice, class Lattice, class Func>
+auto dispatch_lattice(uint32_t L, Func&& func)
+{
+	using Result = decltype(func.template operator()<Lattice>());
+	return [&]<uint32_t... Ls>(std::integer_sequence<uint32_t, Ls...>)->Result
+	{
+		std::optional<Result> res;
+		((L == Ls && (res.emplace(func.template operator()<StaticLattice<Ls>>()), true))
+		 || ...);
+		if(!res) { return func.template operator()<Lattice>(); }
+		return *std::move(res);
+	}
+	(static_lattice_sizes{});
+}
@@ -23,34 +23,34 @@
 
 namespace UnionFindCPP
 {
-inline auto is_horizontal(uint32_t L, Edge e) -> bool
+constexpr auto is_horizontal(uint32_t L, Edge e) -> bool
 {
 	return ((e.v - e.u) == 1) || ((e.v - e.u) == (L - 1));
 }
-inline auto is_vertical(uint32_t L, Edge e) -> bool
+constexpr auto is_vertical(uint32_t L, Edge e) -> bool
 {
 	return !is_horizontal(L, e);
 }
-inline auto lower(uint32_t L, Edge e) -> uint32_t // works only when vertical
+constexpr auto lower(uint32_t L, Edge e) -> uint32_t // works only when vertical
 {
 	if((e.v - e.u) == L) { return e.u; }
 	// else
 	return e.v;
 }
-inline auto upper(uint32_t L, Edge e) -> uint32_t
+constexpr auto upper(uint32_t L, Edge e) -> uint32_t
 {
 	if((e.v - e.u) == L) { return e.v; }
 	// else
 	return e.u;
 }
 
-inline auto left(uint32_t /*L*/, Edge e) -> uint32_t // works only when horizontal
+constexpr auto left(uint32_t /*L*/, Edge e) -> uint32_t // works only when horizontal
 {
 	if((e.v - e.u) == 1) { return e.u; }
 	// else
 	return e.v;
 }
-inline auto right(uint32_t /*L*/, Edge e) -> uint32_t // works only when horizontal
+constexpr auto right(uint32_t /*L*/, Edge e) -> uint32_t // works only when horizontal
 {
 	if((e.v - e.u) == 1) { return e.v; }
 	// else
@@ -88,13 +88,13 @@ constexpr auto to_vertex_index(uint32_t L, const uint32_t row, const uint32_t co
 	return (((row + L) % L)) * L + (col + L) % L;
 }
 
-inline auto vertex_to_coord(const uint32_t L, const uint32_t vidx)
+constexpr auto vertex_to_coord(const uint32_t L, const uint32_t vidx)
 	-> std::tuple<uint32_t, uint32_t>
 {
 	return std::make_tuple(vidx / L, vidx % L);
 }
 
-inline auto to_edge_idx(const uint32_t L, const Edge e) -> uint32_t
+constexpr auto to_edge_idx(const uint32_t L, const Edge e) -> uint32_t
 {
 	if(is_horizontal(L, e))
 	{
@@ -0,0 +1,320 @@
+#pragma once
+
+#include "Decoder.hpp"
+#include "LatticeConcept.hpp"
+#include "LogicalObservables.hpp"
+#include "utility.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace UnionFindCPP
+{
+/**
+ * @brief Decode many independent shots in parallel.
+ *
+ * BatchDecoder owns a pool of worker threads, each with its own DecoderType whose
+ * internal state is reused from shot to shot. All decoders share a single immutable
+ * lattice. The calling thread also works on the batch, so num_threads is the total
+ * number of threads used for decoding.
+ *
+ * decode_batch must not be called concurrently on the same object.
+ */
+template<LatticeConcept Lattice, typename DecoderType = Decoder<Lattice>>
+class BatchDecoder
+{
+private:
+	std::vector<DecoderType> decoders_; // index: worker
+	std::vector<std::vector<typename DecoderType::Index>> edge_indices_; // index: worker
+	std::vector<std::thread> workers_;
+
+	std::mutex mutex_;
+	std::condition_variable start_cv_;
+	std::condition_variable done_cv_;
+	uint64_t generation_ = 0;
+	size_t num_busy_ = 0;
+	bool stop_ = false;
+
+	std::function<void(size_t)> job_;
+	std::atomic<size_t> next_shot_ = 0;
+	std::exception_ptr error_;
+
+	void run_job(size_t worker_idx)
+	{
+		try
+		{
+			job_(worker_idx);
+		}
+		catch(...)
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			if(!error_) { error_ = std::current_exception(); }
+			next_shot_ = std::numeric_limits<size_t>::max() / 2; // stop other workers
+		}
+	}
+
+	void worker_loop(size_t worker_idx)
+	{
+		uint64_t seen_generation = 0;
+		while(true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				start_cv_.wait(lock, [&]
+							   { return stop_ || generation_ != seen_generation; });
+				if(stop_) { return; }
+				seen_generation = generation_;
+			}
+
+			run_job(worker_idx);
+
+			{
+				const std::lock_guard<std::mutex> lock(mutex_);
+				if(--num_busy_ == 0) { done_cv_.notify_one(); }
+			}
+		}
+	}
+
+	/**
+	 * @brief Call decode_shot(worker_idx, shot) for all shots, distributed over the
+	 * workers. Returns when all shots are decoded.
+	 */
+	template<typename Func> void run_shots(size_t num_shots, Func&& decode_shot)
+	{
+		next_shot_ = 0;
+		error_ = nullptr;
+		job_ = [&, this](size_t worker_idx)
+		{
+			for(size_t shot = next_shot_++; shot < num_shots; shot = next_shot_++)
+			{
+				decode_shot(worker_idx, shot);
+			}
+		};
+
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			num_busy_ = workers_.size();
+			++generation_;
+		}
+		start_cv_.notify_all();
+
+		run_job(0);
+
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			done_cv_.wait(lock, [this] { return num_busy_ == 0; });
+		}
+		job_ = nullptr;
+
+		if(error_) { std::rethrow_exception(error_); }
+	}
+
+	void stop_workers()
+	{
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+		start_cv_.notify_all();
+		for(auto& worker : workers_) { worker.join(); }
+	}
+
+	[[nodiscard]] auto num_shots(size_t num_syndromes) const -> size_t
+	{
+		const size_t n_vertices = num_vertices();
+		if(n_vertices == 0)
+		{
+			throw std::invalid_argument("Lattice must have at least one vertex");
+		}
+		if(num_syndromes % n_vertices != 0)
+		{
+			throw std::invalid_argument(
+				"Size of syndromes must be a multiple of the number of vertices");
+		}
+		return num_syndromes / n_vertices;
+	}
+
+public:
+	/**
+	 * @brief Construct a batch decoder. All workers share the given lattice.
+	 *
+	 * @param num_threads total number of threads. If 0, the number of hardware threads
+	 * is used.
+	 * @param lattice lattice shared by the decoders of all workers
+	 */
+	BatchDecoder(size_t num_threads, std::shared_ptr<const Lattice> lattice)
+	{
+		if(num_threads == 0)
+		{
+			num_threads = std::max(1U, std::thread::hardware_concurrency());
+		}
+
+		decoders_.reserve(num_threads);
+		for(size_t idx = 0; idx < num_threads; ++idx) { decoders_.emplace_back(lattice); }
+		edge_indices_.resize(num_threads);
+
+		workers_.reserve(num_threads - 1);
+		try
+		{
+			for(size_t idx = 1; idx < num_threads; ++idx)
+			{
+				workers_.emplace_back([this, idx] { worker_loop(idx); });
+			}
+		}
+		catch(...)
+		{
+			// the destructor does not run, so join the workers already started here
+			stop_workers();
+			throw;
+		}
+	}
+
+	/**
+	 * @brief Construct a batch decoder together with a lattice shared by all workers.
+	 * Arguments after num_threads are forwarded to the constructor of Lattice.
+	 */
+	template<typename... Args>
+	requires std::constructible_from<Lattice, Args...>
+	explicit BatchDecoder(size_t num_threads, Args&&... args)
+		: BatchDecoder(num_threads,
+					   std::make_shared<const Lattice>(std::forward<Args>(args)...))
+	{ }
+
+	BatchDecoder(const BatchDecoder&) = delete;
+	BatchDecoder(BatchDecoder&&) = delete;
+	auto operator=(const BatchDecoder&) -> BatchDecoder& = delete;
+	auto operator=(BatchDecoder&&) -> BatchDecoder& = delete;
+
+	~BatchDecoder() { stop_workers(); }
+
+	[[nodiscard]] auto num_threads() const -> size_t { return decoders_.size(); }
+
+	[[nodiscard]] auto lattice() const -> const Lattice&
+	{
+		return decoders_.front().lattice();
+	}
+
+	/**
+	 * @brief Set the growth policy of the decoders of all workers
+	 */
+	void set_growth_policy(GrowthPolicy growth_policy)
+	{
+		for(auto& decoder : decoders_) { decoder.set_growth_policy(growth_policy); }
+	}
+
+	/**
+	 * @brief Set the logical observables of the decoders of all workers
+	 */
+	void set_observables(const std::shared_ptr<const LogicalObservables>& observables)
+	{
+		for(auto& decoder : decoders_) { decoder.set_observables(observables); }
+	}
+
+	[[nodiscard]] auto num_vertices() const -> size_t
+	{
+		return decoders_.front().num_vertices();
+	}
+
+	[[nodiscard]] auto num_edges() const -> size_t
+	{
+		return decoders_.front().num_edges();
+	}
+
+	/**
+	 * @brief Decode a block of shots.
+	 *
+	 * @param syndromes row-major array of shape (num_shots, num_vertices). A vertex has a
+	 * defect if the value is odd.
+	 * @param corrections row-major array of shape (num_shots, num_edges). For each shot,
+	 * an element is set to 1 if the edge is in the correction and 0 otherwise.
+	 */
+	template<std::integral SyndromeT, typename CorrectionT>
+	void decode_batch(std::span<const SyndromeT> syndromes,
+					  std::span<CorrectionT> corrections)
+	{
+		const size_t n_vertices = num_vertices();
+		const size_t n_edges = num_edges();
+		const size_t n_shots = num_shots(syndromes.size());
+		if(corrections.size() != n_shots * n_edges)
+		{
+			throw std::invalid_argument(
+				"Size of corrections must be (number of shots) x (number of edges)");
+		}
+
+		run_shots(n_shots,
+				  [&](size_t worker_idx, size_t shot)
+				  {
+					  decoders_[worker_idx].decode(
+						  syndromes.subspan(shot * n_vertices, n_vertices),
+						  corrections.subspan(shot * n_edges, n_edges));
+				  });
+	}
+
+	/**
+	 * @brief Decode a block of shots and write only the logical observables flipped by
+	 * the correction of each shot. Observables must be set with set_observables.
+	 *
+	 * @param syndromes row-major array of shape (num_shots, num_vertices)
+	 * @param observables bitmask of flipped observables for each shot
+	 */
+	template<std::integral SyndromeT>
+	void decode_batch_observables(std::span<const SyndromeT> syndromes,
+								  std::span<uint64_t> observables)
+	{
+		const size_t n_vertices = num_vertices();
+		const size_t n_shots = num_shots(syndromes.size());
+		if(observables.size() != n_shots)
+		{
+			throw std::invalid_argument(
+				"Size of observables must be the number of shots");
+		}
+
+		run_shots(n_shots,
+				  [&](size_t worker_idx, size_t shot)
+				  {
+					  observables[shot] = decoders_[worker_idx].decode_observables(
+						  syndromes.subspan(shot * n_vertices, n_vertices));
+				  });
+	}
+
+	/**
+	 * @brief Decode a block of shots and pass the original indices of the edges in the
+	 * correction of each shot to on_shot(shot, edge_indices).
+	 *
+	 * on_shot is called from the worker thread that decoded the shot, so calls for
+	 * different shots run concurrently. edge_indices is a buffer of the worker which is
+	 * reused for its next shot, and may be modified by on_shot. This lets the caller
+	 * write corrections in its own format (e.g. sparse or bit-packed) without a dense
+	 * array over the edges.
+	 *
+	 * @param syndromes row-major array of shape (num_shots, num_vertices)
+	 */
+	template<std::integral SyndromeT, typename Func>
+	void decode_batch_edges(std::span<const SyndromeT> syndromes, Func&& on_shot)
+	{
+		const size_t n_vertices = num_vertices();
+		const size_t n_shots = num_shots(syndromes.size());
+
+		run_shots(n_shots,
+				  [&](size_t worker_idx, size_t shot)
+				  {
+					  auto& edge_indices = edge_indices_[worker_idx];
+					  decoders_[worker_idx].decode(
+						  syndromes.subspan(shot * n_vertices, n_vertices), edge_indices);
+					  on_shot(shot, edge_indices);
+				  });
+	}
+};
+} // namespace UnionFindCPP
@@ -1,120 +1,334 @@
 #pragma once
 
+#include "DecoderState.hpp"
+#include "DenseRootManager.hpp"
+#include "FindRootPolicy.hpp"
+#include "HugePageAllocator.hpp"
 #include "LatticeConcept.hpp"
+#include "LogicalObservables.hpp"
 #include "RootManager.hpp"
 #include "utility.hpp"
 
-#include <tsl/robin_map.h>
-#include <tsl/robin_set.h>
-
 #include <algorithm>
 #include <array>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <map>
+#include <memory>
+#include <numeric>
 #include <queue>
 #include <set>
+#include <stdexcept>
+#include <span>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace UnionFindCPP
 {
-template<LatticeConcept Lattice> class Decoder
+/**
+ * @brief Order in which odd clusters are grown
+ */
+enum class GrowthPolicy
+{
+	/* grow all odd clusters by a half-edge in each round, then fuse */
+	AllOddClusters,
+	/*
+	 * grow the smallest odd cluster and fuse before choosing the next one, as in the
+	 * original Union-Find decoder
+	 */
+	SmallestFirst,
+};
+
+/**
+ * @brief Union-Find decoder
+ *
+ * @tparam Lattice lattice type satisfying LatticeConcept
+ * @tparam RootManagerType container for cluster roots. BasicDenseRootManager (default)
+ * stores cluster data in arrays indexed by vertex, whereas RootManager uses hash
+ * containers.
+ * @tparam FindRootPolicy path compression strategy of find_root. One of PathHalving
+ * (default), PathSplitting and PathCompression defined in FindRootPolicy.hpp.
+ * @tparam DecoderStateType layout of the state modified during decoding. BasicWideState
+ * (default) or BasicCompactState defined in DecoderState.hpp.
+ *
+ * Vertices and edge indices have the index type of the lattice (lattice_index_t), e.g.
+ * uint16_t for BasicLatticeFromParity<uint16_t>, and so do all arrays of the decoder.
+ * The root manager and the state must use the same type.
+ */
+template<LatticeConcept Lattice,
+		 typename RootManagerType = BasicDenseRootManager<lattice_index_t<Lattice>>,
+		 typename FindRootPolicy = PathHalving,
+		 typename DecoderStateType = BasicWideState<lattice_index_t<Lattice>>>
+class Decoder
 {
 public:
-	using Vertex = uint32_t;
-	using RootIterator = tsl::robin_set<Vertex>::const_iterator;
+	using Index = lattice_index_t<Lattice>;
+	using Vertex = Index;
 
 private:
-	const Lattice lattice_;
+	static_assert(std::is_same_v<typename RootManagerType::Vertex, Vertex>
+					  && std::is_same_v<typename DecoderStateType::Vertex, Vertex>,
+				  "Root manager and decoder state must use the index type of the "
+				  "lattice");
 
-	/* index: vertex */
-	std::vector<Vertex> connection_counts_;
+	constexpr static Vertex no_vertex = std::numeric_limits<Vertex>::max();
+	constexpr static size_t default_scratch_capacity = size_t{1} << 16U;
 
-	/* index: edge index */
-	std::vector<uint32_t> support_;
-	std::deque<Edge> fuse_list_;
+	/* An edge together with its index in the lattice */
+	struct IndexedEdge
+	{
+		Vertex u;
+		Vertex v;
+		Index idx;
+	};
 
-	/* index: vertex */
-	std::vector<Vertex> root_of_vertex_; // root of vertex
+	/* Immutable and can be shared with other decoders */
+	std::shared_ptr<const Lattice> lattice_;
+	/* Logical observables over the edges of the lattice. Null if not set */
+	std::shared_ptr<const LogicalObservables> observables_;
 
-	RootManager mgr_;
-	/* key: root, value: borders */
-	tsl::robin_map<Vertex, tsl::robin_set<Vertex>> border_vertices_;
+	/* Support of edges, connection counts, border lists, peeling degrees and parities */
+	DecoderStateType state_;
+	/* Fully grown edges to be fused, in the order of growth */
+	std::vector<IndexedEdge> fuse_list_;
+
+	/* index: vertex */
+	LargeVector<Vertex> root_of_vertex_; // root of vertex
+
+	RootManagerType mgr_;
+
+	GrowthPolicy growth_policy_ = GrowthPolicy::AllOddClusters;
+	/* Odd roots queued for GrowthPolicy::SmallestFirst. index: cluster size */
+	std::vector<std::vector<Vertex>> size_buckets_;
+	/* index: root. Size with which the root is in size_buckets_, 0 if not queued */
+	LargeVector<Vertex> queued_size_;
+
+	/*
+	 * Border vertices of each cluster as a singly linked list. A vertex belongs to at
+	 * most one cluster, so a single next pointer per vertex (state_.border_next) is
+	 * enough and two lists are merged in O(1). Fully grown vertices are unlinked lazily
+	 * in grow.
+	 */
+	/* index: root */
+	LargeVector<Vertex> border_head_;
+	LargeVector<Vertex> border_tail_;
 
 	/* Data for peeling */
-	std::deque<Edge> peeling_edges_;
+	std::vector<IndexedEdge> peeling_edges_;
+	/* index: vertex. XOR of neighbors and of the indices of edges in the spanning
+	 * forest */
+	LargeVector<Vertex> peel_neighbors_;
+	LargeVector<Index> peel_edges_;
+	std::vector<Vertex> peel_leaves_;
+	/* Result of the last decoding in the internal numbering */
+	std::vector<IndexedEdge> corrections_;
+
+	/* Vertices with odd syndromes in the current decoding */
+	std::vector<Vertex> syndrome_vertices_;
+	/* Vertices with non-zero connection counts and edges with non-zero support */
+	std::vector<Vertex> touched_vertices_;
+	std::vector<Index> touched_edges_;
+
+	/* Largest capacity (in elements) of a scratch buffer kept by clear() */
+	size_t scratch_capacity_ = default_scratch_capacity;
+
+	/**
+	 * @brief Empty a scratch buffer. Its memory is kept for the next decoding unless
+	 * the buffer has grown beyond scratch_capacity_.
+	 */
+	template<typename T> void clear_scratch(std::vector<T>& buffer) const
+	{
+		buffer.clear();
+		if(buffer.capacity() > scratch_capacity_) { std::vector<T>().swap(buffer); }
+	}
+
+	/**
+	 * @brief Reset state_ and root_of_vertex_ to their initial values. Only the entries
+	 * modified by the previous decoding are visited.
+	 */
+	void reset_touched()
+	{
+		for(const auto v : touched_vertices_)
+		{
+			state_.connection_count(v) = 0;
+			root_of_vertex_[v] = v;
+			state_.border_next(v) = no_vertex;
+			state_.parity(v) = 0;
+		}
+		for(const auto v : syndrome_vertices_)
+		{
+			root_of_vertex_[v] = v;
+			state_.parity(v) = 0;
+			border_head_[v] = no_vertex;
+			border_tail_[v] = no_vertex;
+			state_.border_next(v) = no_vertex;
+			queued_size_[v] = 0;
+		}
+		for(const auto edge_idx : touched_edges_) { state_.reset_support(edge_idx); }
+
+		touched_vertices_.clear();
+		touched_edges_.clear();
+	}
 
-	void init_cluster(const std::vector<uint32_t>& roots)
+	void init_cluster(const std::vector<Vertex>& roots)
 	{
-		connection_counts_ = std::vector<Vertex>(lattice_.num_vertices(), 0);
-		support_ = std::vector<uint32_t>(lattice_.num_edges(), 0);
 		mgr_.initialize_roots(roots);
-		for(auto root : roots) { border_vertices_[root].emplace(root); }
+		for(auto root : roots)
+		{
+			state_.parity(root) = 1;
+			border_head_[root] = root;
+			border_tail_[root] = root;
+		}
+	}
 
-		root_of_vertex_.resize(lattice_.num_vertices());
+	void push_border(Vertex root, Vertex vertex)
+	{
+		if(border_head_[root] == no_vertex) { border_head_[root] = vertex; }
+		else
+		{
+			state_.border_next(border_tail_[root]) = vertex;
+		}
+		border_tail_[root] = vertex;
+	}
 
-		for(uint32_t u = 0; u < lattice_.num_vertices(); ++u) { root_of_vertex_[u] = u; }
+	/**
+	 * @brief Grow the given edge by a half-edge
+	 */
+	void grow_edge(Vertex u, Vertex v, Index edge_idx)
+	{
+		const uint32_t support = state_.support(edge_idx);
+		if(support == 2) { return; }
+		if(support == 0) { touched_edges_.emplace_back(edge_idx); }
+		if(state_.grow_support(edge_idx) == 2)
+		{
+			if(state_.connection_count(u)++ == 0) { touched_vertices_.emplace_back(u); }
+			if(state_.connection_count(v)++ == 0) { touched_vertices_.emplace_back(v); }
+			fuse_list_.push_back(IndexedEdge{u, v, edge_idx});
+		}
 	}
 
 	void grow(Vertex root)
 	{
-		for(auto border_vertex : border_vertices_[root])
+		const Lattice& lattice = *lattice_;
+		Vertex prev = no_vertex;
+		Vertex border_vertex = border_head_[root];
+		while(border_vertex != no_vertex)
 		{
-			for(auto v : lattice_.vertex_connections(border_vertex))
+			const Vertex next = state_.border_next(border_vertex);
+
+			// unlink a vertex whose edges are all fully grown
+			if(state_.connection_count(border_vertex)
+			   == lattice.vertex_connection_count(border_vertex))
 			{
-				auto edge = Edge(border_vertex, v);
+				if(prev == no_vertex) { border_head_[root] = next; }
+				else
+				{
+					state_.border_next(prev) = next;
+				}
+				if(next == no_vertex) { border_tail_[root] = prev; }
+				state_.border_next(border_vertex) = no_vertex;
+				border_vertex = next;
+				continue;
+			}
 
-				auto& elt = support_[lattice_.edge_idx(edge)];
-				if(elt == 2) { continue; }
-				if(++elt == 2)
+			if constexpr(LatticeWithNeighborEdges<Lattice>)
+			{
+				for(const auto& neighbor : lattice.vertex_neighbors(border_vertex))
+				{
+					grow_edge(border_vertex, neighbor.vertex, neighbor.edge_idx);
+				}
+			}
+			else
+			{
+				for(auto v : lattice.vertex_connections(border_vertex))
 				{
-					connection_counts_[edge.u]++;
-					connection_counts_[edge.v]++;
-					fuse_list_.emplace_back(edge);
+					grow_edge(border_vertex, v, lattice.edge_idx(Edge(border_vertex, v)));
 				}
 			}
+
+			prev = border_vertex;
+			border_vertex = next;
 		}
 	}
 
-	auto find_root(Vertex vertex) -> Vertex
+	[[nodiscard]] auto cluster_size(Vertex root) const -> Vertex
 	{
-		Vertex tmp = root_of_vertex_[vertex];
-		if(tmp == vertex) { return vertex; }
+		return std::as_const(mgr_).size(root);
+	}
 
-		std::vector<Vertex> path;
-		Vertex root{};
-		do {
-			root = tmp;
-			path.emplace_back(root);
-			tmp = root_of_vertex_[root];
-		} while(tmp != root);
+	/**
+	 * @brief Put an odd root to the bucket of its current size. Entries left in
+	 * smaller buckets become stale and are skipped when popped.
+	 */
+	void queue_root(Vertex root)
+	{
+		const Vertex size = cluster_size(root);
+		if(queued_size_[root] == size) { return; }
+		queued_size_[root] = size;
+		if(size >= size_buckets_.size()) { size_buckets_.resize(size + 1); }
+		size_buckets_[size].emplace_back(root);
+	}
 
-		// now root == (tmp = root_of_vertex_[root])
+	/**
+	 * @brief Grow the smallest odd cluster by a half-edge and fuse, until no odd
+	 * cluster is left.
+	 *
+	 * Cluster sizes only increase, and every queued size is at least the size of the
+	 * cluster grown last, so buckets are visited in a single forward sweep.
+	 */
+	void grow_smallest_first()
+	{
+		for(auto root : mgr_.odd_roots()) { queue_root(root); }
 
-		for(const auto v : path) { root_of_vertex_[v] = root; }
-		return root;
+		for(size_t size = 0; size < size_buckets_.size(); ++size)
+		{
+			while(!size_buckets_[size].empty())
+			{
+				const Vertex root = size_buckets_[size].back();
+				size_buckets_[size].pop_back();
+				if(queued_size_[root] != size) { continue; } // stale entry
+				queued_size_[root] = 0;
+				if(!mgr_.is_odd_root(root)) { continue; }
+
+				grow(root);
+				fusion();
+
+				const Vertex new_root = find_root(root);
+				if(mgr_.is_odd_root(new_root)) { queue_root(new_root); }
+			}
+		}
+		assert(mgr_.isempty_odd_root());
+	}
+
+	auto find_root(Vertex vertex) -> Vertex
+	{
+		return FindRootPolicy::find_root(root_of_vertex_, vertex);
 	}
 
 	void merge_boundary(Vertex root1, Vertex root2)
 	{
-		border_vertices_[root1].insert(border_vertices_[root2].cbegin(),
-									   border_vertices_[root2].cend());
+		const Vertex head2 = border_head_[root2];
+		if(head2 == no_vertex) { return; }
 
-		for(auto vertex : border_vertices_[root2])
+		if(border_head_[root1] == no_vertex) { border_head_[root1] = head2; }
+		else
 		{
-			if(connection_counts_[vertex] == lattice_.vertex_connection_count(vertex))
-			{
-				border_vertices_[root1].erase(vertex);
-			}
+			state_.border_next(border_tail_[root1]) = head2;
 		}
-		border_vertices_.erase(root2);
+		border_tail_[root1] = border_tail_[root2];
+
+		border_head_[root2] = no_vertex;
+		border_tail_[root2] = no_vertex;
 	}
 
 	void fusion()
 	{
-		while(!fuse_list_.empty())
+		for(const auto& fuse_edge : fuse_list_)
 		{
-			Edge fuse_edge = fuse_list_.front();
-			fuse_list_.pop_front();
 			auto root1 = find_root(fuse_edge.u);
 			auto root2 = find_root(fuse_edge.v);
 
@@ -133,108 +347,424 @@ private:
 			if(!mgr_.is_root(root2)) // if merging one is a single vertex
 			{
 				++mgr_.size(root1);
-				border_vertices_[root1].emplace(root2);
+				push_border(root1, root2);
 			}
 			else
 			{
 				mgr_.merge(root1, root2);
 				merge_boundary(root1, root2);
 			}
+
+			if(growth_policy_ == GrowthPolicy::SmallestFirst && mgr_.is_odd_root(root1))
+			{
+				queue_root(root1);
+			}
 		}
+		fuse_list_.clear();
 	}
 
-	auto peeling(std::vector<uint32_t>& syndromes) -> std::vector<Edge>
+	/**
+	 * @brief Vertex used inside the decoder for the given vertex of a syndrome
+	 */
+	[[nodiscard]] auto internal_vertex(Vertex v) const -> Vertex
 	{
-		std::vector<Edge> corrections;
+		if constexpr(LatticeWithInternalOrder<Lattice>)
+		{
+			return lattice_->internal_vertex(v);
+		}
+		else { return v; }
+	}
 
-		// vs vector?
-		tsl::robin_map<Vertex, int> vertex_count;
+	[[nodiscard]] auto original_vertex(Vertex v) const -> Vertex
+	{
+		if constexpr(LatticeWithInternalOrder<Lattice>)
+		{
+			return lattice_->original_vertex(v);
+		}
+		else { return v; }
+	}
+
+	[[nodiscard]] auto original_edge_idx(Index edge_idx) const -> Index
+	{
+		if constexpr(LatticeWithInternalOrder<Lattice>)
+		{
+			return lattice_->original_edge_idx(edge_idx);
+		}
+		else { return edge_idx; }
+	}
+
+	/**
+	 * @brief Peel the spanning forest given by peeling_edges_.
+	 *
+	 * Each vertex keeps its degree in the forest and the XOR of its neighbors, so the
+	 * only neighbor of a leaf is known without an adjacency list. Leaves are processed
+	 * from a stack, hence the cost is linear in the number of forest edges. All
+	 * entries of state_.peel_degree, peel_neighbors_ and peel_edges_ are back to zero
+	 * when it returns. The edges to correct are written to corrections_.
+	 */
+	void peeling()
+	{
+		corrections_.clear();
 
-		for(Edge edge : peeling_edges_)
+		for(const auto& [u, v, idx] : peeling_edges_)
 		{
-			++vertex_count[edge.u];
-			++vertex_count[edge.v];
+			++state_.peel_degree(u);
+			++state_.peel_degree(v);
+			peel_neighbors_[u] ^= v;
+			peel_neighbors_[v] ^= u;
+			peel_edges_[u] ^= idx;
+			peel_edges_[v] ^= idx;
 		}
 
-		while(!peeling_edges_.empty())
+		peel_leaves_.clear();
+		for(const auto& [u, v, idx] : peeling_edges_)
 		{
-			Edge leaf_edge = peeling_edges_.back();
-			peeling_edges_.pop_back();
-			auto u = Vertex{};
-			auto v = Vertex{};
-			if(vertex_count[leaf_edge.u] == 1)
+			if(state_.peel_degree(u) == 1) { peel_leaves_.emplace_back(u); }
+			if(state_.peel_degree(v) == 1) { peel_leaves_.emplace_back(v); }
+		}
+		peeling_edges_.clear();
+
+		while(!peel_leaves_.empty())
+		{
+			const Vertex u = peel_leaves_.back();
+			peel_leaves_.pop_back();
+
+			// the last vertex of a tree
+			if(state_.peel_degree(u) != 1) { continue; }
+
+			const Vertex v = peel_neighbors_[u];
+			const Index idx = peel_edges_[u];
+			state_.peel_degree(u) = 0;
+			peel_neighbors_[u] = 0;
+			peel_edges_[u] = 0;
+			peel_neighbors_[v] ^= u;
+			peel_edges_[v] ^= idx;
+			if(--state_.peel_degree(v) == 1) { peel_leaves_.emplace_back(v); }
+
+			if(state_.parity(u) == 1)
 			{
-				u = leaf_edge.u;
-				v = leaf_edge.v;
+				corrections_.push_back(IndexedEdge{u, v, idx});
+				state_.parity(u) = 0;
+				state_.parity(v) ^= 1U;
 			}
-			else if(vertex_count[leaf_edge.v] == 1)
+		}
+	}
+
+	/**
+	 * @brief Collect the vertices with odd syndromes to syndrome_vertices_
+	 */
+	template<std::integral T> void find_defects(std::span<const T> syndromes)
+	{
+		assert(syndromes.size() == lattice_->num_vertices());
+		reset_touched();
+
+		syndrome_vertices_.clear();
+		for(size_t n = 0; n < syndromes.size(); ++n)
+		{
+			if((syndromes[n] % 2) != 0)
 			{
-				u = leaf_edge.v;
-				v = leaf_edge.u;
+				syndrome_vertices_.emplace_back(internal_vertex(static_cast<Vertex>(n)));
 			}
-			else // not a leaf
+		}
+	}
+
+	void set_defects(std::span<const Vertex> defects)
+	{
+		reset_touched();
+
+		syndrome_vertices_.clear();
+		for(const auto v : defects)
+		{
+			assert(v < lattice_->num_vertices());
+			syndrome_vertices_.emplace_back(internal_vertex(v));
+		}
+	}
+
+	/**
+	 * @brief Grow the clusters of the vertices in syndrome_vertices_ until all of them
+	 * are even and write the edges to correct to corrections_
+	 */
+	void decode_syndrome_vertices()
+	{
+		if constexpr(LatticeWithInternalOrder<Lattice>)
+		{
+			// clusters are initialized in the internal order for locality
+			if(!std::is_sorted(syndrome_vertices_.begin(), syndrome_vertices_.end()))
 			{
-				peeling_edges_.push_front(leaf_edge);
-				continue;
+				std::sort(syndrome_vertices_.begin(), syndrome_vertices_.end());
 			}
+		}
 
-			--vertex_count[u];
-			--vertex_count[v];
+		init_cluster(syndrome_vertices_);
 
-			if(syndromes[u] == 1)
+		if(growth_policy_ == GrowthPolicy::SmallestFirst) { grow_smallest_first(); }
+		else
+		{
+			while(!mgr_.isempty_odd_root())
 			{
-				corrections.emplace_back(leaf_edge);
-				syndromes[u] = 0;
-				syndromes[v] ^= 1U;
+				for(auto root : mgr_.odd_roots()) { grow(root); }
+				fusion();
 			}
 		}
-		return corrections;
+
+		peeling();
+	}
+
+	/**
+	 * @brief Logical observables flipped by corrections_ as a bitmask
+	 */
+	[[nodiscard]] auto flipped_observables() const -> uint64_t
+	{
+		uint64_t res = 0;
+		for(const auto& correction : corrections_)
+		{
+			res ^= observables_->mask(original_edge_idx(correction.idx));
+		}
+		return res;
+	}
+
+	void write_edge_indices(std::vector<Index>& corrections) const
+	{
+		corrections.clear();
+		for(const auto& correction : corrections_)
+		{
+			corrections.push_back(original_edge_idx(correction.idx));
+		}
 	}
 
 public:
-	template<typename... Args> explicit Decoder(Args&&... args) : lattice_{args...} { }
+	/**
+	 * @brief Construct a decoder over a lattice shared with other decoders.
+	 *
+	 * Only the internal state for decoding is allocated, so many decoders (e.g. one per
+	 * thread) can be built over a single large lattice.
+	 */
+	explicit Decoder(std::shared_ptr<const Lattice> lattice)
+		: lattice_{std::move(lattice)}, state_(*lattice_),
+		  root_of_vertex_(lattice_->num_vertices()), mgr_(lattice_->num_vertices()),
+		  queued_size_(lattice_->num_vertices(), 0),
+		  border_head_(lattice_->num_vertices(), no_vertex),
+		  border_tail_(lattice_->num_vertices(), no_vertex),
+		  peel_neighbors_(lattice_->num_vertices(), 0),
+		  peel_edges_(lattice_->num_vertices(), 0)
+	{
+		std::iota(root_of_vertex_.begin(), root_of_vertex_.end(), Vertex{0});
+	}
 
-	auto decode(std::vector<uint32_t>& syndromes) -> std::vector<Edge>
+	/**
+	 * @brief Construct a decoder together with its own lattice. All arguments are
+	 * forwarded to the constructor of Lattice.
+	 */
+	template<typename... Args>
+	requires std::constructible_from<Lattice, Args...>
+	explicit Decoder(Args&&... args)
+		: Decoder(std::make_shared<const Lattice>(std::forward<Args>(args)...))
+	{ }
+
+	/**
+	 * @brief Decode the given syndromes.
+	 *
+	 * Internal arrays are allocated once in the constructor, and only the entries
+	 * touched by the previous decoding are reset. Thus the cost of decoding is
+	 * proportional to the size of the clusters (apart from a linear scan of the
+	 * syndromes) when the same decoder is reused.
+	 *
+	 * @param syndromes array of length num_vertices. A vertex has a defect if the value
+	 * is odd. The array is not modified.
+	 * @return edges to correct. Syndromes and corrections use the original numbering of
+	 * vertices also when the lattice is reordered. Only available for lattices with
+	 * indices of at most 32 bits, as Edge holds 32-bit vertices.
+	 */
+	template<std::integral T>
+	requires(sizeof(Vertex) <= sizeof(uint32_t))
+	auto decode(std::span<const T> syndromes) -> std::vector<Edge>
 	{
-		assert(syndromes.size() == lattice_.num_vertices());
-		std::vector<Vertex> syndrome_vertices;
-		for(uint32_t n = 0; n < syndromes.size(); ++n)
+		find_defects(syndromes);
+		decode_syndrome_vertices();
+
+		std::vector<Edge> res;
+		res.reserve(corrections_.size());
+		for(const auto& correction : corrections_)
 		{
-			if((syndromes[n] % 2) != 0) { syndrome_vertices.emplace_back(n); }
+			res.emplace_back(original_vertex(correction.u),
+							 original_vertex(correction.v));
 		}
+		return res;
+	}
 
-		init_cluster(syndrome_vertices);
+	auto decode(const std::vector<uint32_t>& syndromes) -> std::vector<Edge>
+	requires(sizeof(Vertex) <= sizeof(uint32_t))
+	{
+		return decode(std::span<const uint32_t>(syndromes));
+	}
+
+	/**
+	 * @brief Decode the given syndromes and write the indices of the edges to correct
+	 * to corrections, which is cleared first.
+	 *
+	 * Once the internal buffers and corrections have grown to their working sizes,
+	 * no memory is allocated.
+	 */
+	template<std::integral T>
+	void decode(std::span<const T> syndromes, std::vector<Index>& corrections)
+	{
+		find_defects(syndromes);
+		decode_syndrome_vertices();
+		write_edge_indices(corrections);
+	}
 
-		while(!mgr_.isempty_odd_root())
+	/**
+	 * @brief Decode the given syndromes and write a 0/1 array over the edges to
+	 * corrections, whose length must be num_edges. No memory is allocated once the
+	 * internal buffers have grown to their working sizes.
+	 */
+	template<std::integral T, typename U>
+	requires std::is_arithmetic_v<U>
+	void decode(std::span<const T> syndromes, std::span<U> corrections)
+	{
+		assert(corrections.size() == lattice_->num_edges());
+		find_defects(syndromes);
+		decode_syndrome_vertices();
+
+		std::fill(corrections.begin(), corrections.end(), U{0});
+		for(const auto& correction : corrections_)
 		{
-			for(auto root : mgr_.odd_roots()) { grow(root); }
-			fusion();
+			corrections[original_edge_idx(correction.idx)] = U{1};
 		}
+	}
 
-		return peeling(syndromes);
+	/**
+	 * @brief Decode syndromes given as the list of vertices with defects.
+	 *
+	 * Unlike decode, the syndromes of all vertices are not scanned, so the cost only
+	 * depends on the number of defects and the size of the clusters. Useful for large
+	 * lattices at low error rates.
+	 *
+	 * @param defects distinct vertices with odd syndromes
+	 * @return indices of the edges to correct
+	 */
+	auto decode_defects(std::span<const Vertex> defects) -> std::vector<Index>
+	{
+		std::vector<Index> res;
+		decode_defects(defects, res);
+		return res;
 	}
 
+	/**
+	 * @brief Same as above but the indices of the edges to correct are written to
+	 * corrections, which is cleared first
+	 */
+	void decode_defects(std::span<const Vertex> defects, std::vector<Index>& corrections)
+	{
+		set_defects(defects);
+		decode_syndrome_vertices();
+		write_edge_indices(corrections);
+	}
+
+	/**
+	 * @brief Decode the given syndromes and return only the logical observables flipped
+	 * by the correction, where bit k corresponds to observable k.
+	 *
+	 * This is all Monte Carlo simulations need, and it is much smaller than the
+	 * correction. Observables must be set with set_observables.
+	 */
+	template<std::integral T> auto decode_observables(std::span<const T> syndromes)
+		-> uint64_t
+	{
+		if(!observables_)
+		{
+			throw std::logic_error("Logical observables of the decoder are not set");
+		}
+		find_defects(syndromes);
+		decode_syndrome_vertices();
+		return flipped_observables();
+	}
+
+	/**
+	 * @brief Set the logical observables used by decode_observables. They can be shared
+	 * with other decoders over the same lattice.
+	 */
+	void set_observables(std::shared_ptr<const LogicalObservables> observables)
+	{
+		if(observables && observables->num_edges() != lattice_->num_edges())
+		{
+			throw std::invalid_argument(
+				"Logical observables must be defined over the edges of the lattice");
+		}
+		observables_ = std::move(observables);
+	}
+
+	[[nodiscard]] auto observables_ptr() const
+		-> std::shared_ptr<const LogicalObservables>
+	{
+		return observables_;
+	}
+
+	[[nodiscard]] auto growth_policy() const -> GrowthPolicy { return growth_policy_; }
+
+	void set_growth_policy(GrowthPolicy growth_policy) { growth_policy_ = growth_policy; }
+
 	[[nodiscard]] inline auto num_vertices() const -> int
 	{
-		return lattice_.num_vertices();
+		return lattice_->num_vertices();
 	}
 
-	[[nodiscard]] inline auto num_edges() const -> int { return lattice_.num_edges(); }
+	[[nodiscard]] inline auto num_edges() const -> int { return lattice_->num_edges(); }
 
+	/**
+	 * @brief Index of an edge given in the original numbering of vertices. The index is
+	 * also in the original numbering.
+	 */
 	[[nodiscard]] inline auto edge_idx(const Edge& edge) const -> int
 	{
-		return lattice_.edge_idx(edge);
+		return original_edge_idx(
+			lattice_->edge_idx(Edge(internal_vertex(edge.u), internal_vertex(edge.v))));
 	}
 
-	void clear()
+	[[nodiscard]] inline auto lattice() const -> const Lattice& { return *lattice_; }
+
+	[[nodiscard]] inline auto lattice_ptr() const -> std::shared_ptr<const Lattice>
 	{
-		std::deque<Edge>().swap(fuse_list_);
+		return lattice_;
+	}
+
+	[[nodiscard]] auto scratch_capacity() const -> size_t { return scratch_capacity_; }
+
+	/**
+	 * @brief Set the high-water mark of the scratch buffers (e.g. lists of fused edges,
+	 * touched vertices and corrections) in number of elements.
+	 *
+	 * Buffers grow as needed while decoding and are reused by subsequent decodings.
+	 * clear() only releases the buffers that have grown beyond this capacity, e.g.
+	 * after a rare shot with many defects.
+	 */
+	void set_scratch_capacity(size_t scratch_capacity)
+	{
+		scratch_capacity_ = scratch_capacity;
+	}
 
+	/**
+	 * @brief Reset the decoder. Scratch buffers keep their memory up to
+	 * scratch_capacity() elements, so calling this between decodings does not allocate.
+	 */
+	void clear()
+	{
+		reset_touched();
 		mgr_.clear();
 
-		tsl::robin_map<Vertex, tsl::robin_set<Vertex>>().swap(border_vertices_);
+		clear_scratch(fuse_list_);
+		clear_scratch(peeling_edges_);
+		clear_scratch(peel_leaves_);
+		clear_scratch(corrections_);
+		clear_scratch(syndrome_vertices_);
+		clear_scratch(touched_vertices_);
+		clear_scratch(touched_edges_);
 
-		std::deque<Edge>().swap(peeling_edges_);
+		for(auto& bucket : size_buckets_) { clear_scratch(bucket); }
+		if(size_buckets_.size() > scratch_capacity_)
+		{
+			std::vector<std::vector<Vertex>>().swap(size_buckets_);
+		}
 	}
 };
 } // namespace UnionFindCPP
@@ -0,0 +1,165 @@
+#pragma once
+#include "HugePageAllocator.hpp"
+#include "LatticeConcept.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace UnionFindCPP
+{
+/*
+ * Layouts of the per-vertex and per-edge state of Decoder that is modified during
+ * decoding. Both provide the same interface, so Decoder works with either of them.
+ * Vertex is the index type of the lattice (see lattice_index_t).
+ */
+
+/**
+ * @brief Decoder state in separate arrays of vertex indices. Fastest for small and
+ * medium lattices.
+ */
+template<std::unsigned_integral VertexType> class BasicWideState
+{
+public:
+	using Vertex = VertexType;
+	constexpr static Vertex no_vertex = std::numeric_limits<Vertex>::max();
+
+private:
+	/* index: edge index. Number of grown half-edges, 0, 1 or 2 */
+	LargeVector<uint32_t> support_;
+
+	/* index: vertex. Counts are bounded by the number of edges, which fits in Vertex */
+	LargeVector<Vertex> connection_counts_;
+	LargeVector<Vertex> border_next_;
+	LargeVector<Vertex> peel_degree_;
+	LargeVector<uint8_t> parity_;
+
+public:
+	template<LatticeConcept Lattice>
+	explicit BasicWideState(const Lattice& lattice)
+		: support_(lattice.num_edges(), 0), connection_counts_(lattice.num_vertices(), 0),
+		  border_next_(lattice.num_vertices(), no_vertex),
+		  peel_degree_(lattice.num_vertices(), 0), parity_(lattice.num_vertices(), 0)
+	{ }
+
+	[[nodiscard]] auto support(size_t edge_idx) const -> uint32_t
+	{
+		return support_[edge_idx];
+	}
+
+	/**
+	 * @brief Grow the edge by a half-edge and return the new support
+	 */
+	auto grow_support(size_t edge_idx) -> uint32_t { return ++support_[edge_idx]; }
+
+	void reset_support(size_t edge_idx) { support_[edge_idx] = 0; }
+
+	/* Number of fully grown edges of the vertex */
+	auto connection_count(Vertex v) -> Vertex& { return connection_counts_[v]; }
+	/* Next vertex in the border list of a cluster */
+	auto border_next(Vertex v) -> Vertex& { return border_next_[v]; }
+	/* Degree in the spanning forest during peeling */
+	auto peel_degree(Vertex v) -> Vertex& { return peel_degree_[v]; }
+	auto parity(Vertex v) -> uint8_t& { return parity_[v]; }
+
+	[[nodiscard]] auto memory_bytes() const -> size_t
+	{
+		return support_.size() * sizeof(uint32_t)
+			   + connection_counts_.size()
+					 * (3 * sizeof(Vertex) + sizeof(uint8_t));
+	}
+};
+
+using WideState = BasicWideState<uint32_t>;
+
+/**
+ * @brief Decoder state packed for large lattices.
+ *
+ * Support of each edge is stored in 2 bits, and the fields of a vertex used together
+ * are interleaved in 8 bytes, so growing a border vertex touches a single cache line
+ * for the vertex (8 bytes with 32-bit vertices). Requires that each vertex has at most
+ * 255 neighbors.
+ */
+template<std::unsigned_integral VertexType> class BasicCompactState
+{
+public:
+	using Vertex = VertexType;
+	constexpr static Vertex no_vertex = std::numeric_limits<Vertex>::max();
+
+private:
+	constexpr static uint32_t max_degree = std::numeric_limits<uint8_t>::max();
+	constexpr static uint32_t edges_per_word = 32;
+
+	struct VertexState
+	{
+		Vertex border_next = no_vertex;
+		uint8_t connection_count = 0;
+		uint8_t peel_degree = 0;
+		uint8_t parity = 0;
+	};
+	static_assert(sizeof(VertexState) <= std::max<size_t>(8, 2 * sizeof(Vertex)));
+
+	/* index: edge index / edges_per_word. 2 bits of support per edge */
+	LargeVector<uint64_t> support_;
+	/* index: vertex */
+	LargeVector<VertexState> vertices_;
+
+	constexpr static auto shift(size_t edge_idx) -> uint32_t
+	{
+		return static_cast<uint32_t>(2U * (edge_idx % edges_per_word));
+	}
+
+public:
+	template<LatticeConcept Lattice>
+	explicit BasicCompactState(const Lattice& lattice)
+		: support_((lattice.num_edges() + edges_per_word - 1) / edges_per_word, 0),
+		  vertices_(lattice.num_vertices())
+	{
+		for(Vertex v = 0; v < lattice.num_vertices(); ++v)
+		{
+			if(lattice.vertex_connection_count(v) > max_degree)
+			{
+				throw std::invalid_argument(
+					"CompactState requires that each vertex has at most 255 neighbors");
+			}
+		}
+	}
+
+	[[nodiscard]] auto support(size_t edge_idx) const -> uint32_t
+	{
+		const uint64_t word = support_[edge_idx / edges_per_word];
+		return static_cast<uint32_t>(word >> shift(edge_idx)) & 3U;
+	}
+
+	/**
+	 * @brief Grow the edge by a half-edge and return the new support
+	 */
+	auto grow_support(size_t edge_idx) -> uint32_t
+	{
+		support_[edge_idx / edges_per_word] += uint64_t{1} << shift(edge_idx);
+		return support(edge_idx);
+	}
+
+	void reset_support(size_t edge_idx)
+	{
+		support_[edge_idx / edges_per_word] &= ~(uint64_t{3} << shift(edge_idx));
+	}
+
+	auto connection_count(Vertex v) -> uint8_t& { return vertices_[v].connection_count; }
+	auto border_next(Vertex v) -> Vertex& { return vertices_[v].border_next; }
+	auto peel_degree(Vertex v) -> uint8_t& { return vertices_[v].peel_degree; }
+	auto parity(Vertex v) -> uint8_t& { return vertices_[v].parity; }
+
+	[[nodiscard]] auto memory_bytes() const -> size_t
+	{
+		return support_.size() * sizeof(uint64_t)
+			   + vertices_.size() * sizeof(VertexState);
+	}
+};
+
+using CompactState = BasicCompactState<uint32_t>;
+} // namespace UnionFindCPP
@@ -0,0 +1,156 @@
+#pragma once
+#include "HugePageAllocator.hpp"
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace UnionFindCPP
+{
+/**
+ * @brief Root manager that keeps cluster data in arrays indexed by vertex.
+ *
+ * Drop-in replacement of RootManager. Size and parity of each root are stored next
+ * to each other in a single array, so is_root, size, parity and merge do not need
+ * any hash lookup. Odd roots are kept in a compact list, and each root remembers its
+ * position in the list so that it can be removed in O(1).
+ *
+ * @tparam VertexType index type of the lattice (see lattice_index_t). Sizes and
+ * positions are stored in the same type.
+ */
+template<std::unsigned_integral VertexType> class BasicDenseRootManager
+{
+public:
+	using Vertex = VertexType;
+
+private:
+	constexpr static Vertex not_odd = std::numeric_limits<Vertex>::max();
+
+	struct RootData
+	{
+		Vertex size = 0;
+		/* position in odd_roots_ if the cluster has odd parity, otherwise not_odd */
+		Vertex odd_pos = not_odd;
+	};
+
+	/* index: vertex */
+	LargeVector<RootData> data_;
+	/* list of roots with odd parity */
+	std::vector<Vertex> odd_roots_;
+	/* roots given to initialize_roots. Only these entries of data_ can be non-zero */
+	std::vector<Vertex> roots_;
+
+	void push_odd(Vertex root)
+	{
+		data_[root].odd_pos = static_cast<Vertex>(odd_roots_.size());
+		odd_roots_.emplace_back(root);
+	}
+
+	void erase_odd(Vertex root)
+	{
+		const auto pos = data_[root].odd_pos;
+		if(pos == not_odd) { return; }
+
+		const auto last = odd_roots_.back();
+		odd_roots_[pos] = last;
+		data_[last].odd_pos = pos;
+		odd_roots_.pop_back();
+		data_[root].odd_pos = not_odd;
+	}
+
+public:
+	explicit BasicDenseRootManager(size_t num_vertices) : data_(num_vertices) { }
+
+	void initialize_roots(const std::vector<Vertex>& roots)
+	{
+		clear();
+		roots_ = roots;
+		odd_roots_.reserve(roots.size());
+		for(const auto root : roots)
+		{
+			data_[root].size = 1;
+			push_odd(root);
+		}
+	}
+
+	/* returns 0 if the vertex is not a root */
+	inline auto size(Vertex root) -> Vertex& { return data_[root].size; }
+
+	[[nodiscard]] inline auto size(Vertex root) const -> Vertex
+	{
+		return data_[root].size;
+	}
+
+	[[nodiscard]] inline auto parity(Vertex root) const -> uint32_t
+	{
+		return (data_[root].odd_pos == not_odd) ? 0U : 1U;
+	}
+
+	[[nodiscard]] inline auto is_root(Vertex v) const -> bool { return data_[v].size != 0; }
+
+	[[nodiscard]] inline auto is_odd_root(Vertex v) const -> bool
+	{
+		return data_[v].odd_pos != not_odd;
+	}
+
+	// size of the cluster of root1 is larger than that of root2
+	void merge(Vertex root1, Vertex root2)
+	{
+		const bool odd1 = is_odd_root(root1);
+		const bool odd2 = is_odd_root(root2);
+
+		if(odd1 && odd2) { erase_odd(root1); }
+		else if(odd2) { push_odd(root1); }
+
+		data_[root1].size += data_[root2].size;
+
+		erase_odd(root2);
+		data_[root2].size = 0;
+	}
+
+	void remove(Vertex root)
+	{
+		erase_odd(root);
+		data_[root].size = 0;
+	}
+
+	[[nodiscard]] auto isempty_odd_root() const -> bool { return odd_roots_.empty(); }
+
+	/* Only the entries touched since the last initialization are reset. */
+	void clear()
+	{
+		for(const auto root : roots_) { data_[root] = RootData{}; }
+		roots_.clear();
+		odd_roots_.clear();
+	}
+
+	[[nodiscard]] auto odd_roots() const& -> const std::vector<Vertex>&
+	{
+		return odd_roots_;
+	}
+	[[nodiscard]] auto odd_roots() && -> std::vector<Vertex> { return odd_roots_; }
+
+	void print(std::ostream& os) const
+	{
+		nlohmann::json p;
+
+		auto roots_j = nlohmann::json::array();
+		for(auto root : roots_)
+		{
+			if(!is_root(root)) { continue; }
+			roots_j.emplace_back(nlohmann::json::array({root, size(root), parity(root)}));
+		}
+		p["roots"] = roots_j;
+		p["odd_roots"] = odd_roots_;
+
+		os << p << std::endl;
+	}
+};
+
+using DenseRootManager = BasicDenseRootManager<uint32_t>;
+} // namespace UnionFindCPP
@@ -0,0 +1,68 @@
+#pragma once
+#include <vector>
+
+namespace UnionFindCPP
+{
+/*
+ * Policies for finding the root of a vertex in the union-find forest. Each policy
+ * takes the parent array (root_of_vertex_ of Decoder) and compresses the path in-place,
+ * so no memory is allocated.
+ */
+
+/**
+ * @brief Full path compression in two passes. Every vertex on the path points to the
+ * root afterwards.
+ */
+struct PathCompression
+{
+	template<typename Vertex, typename Allocator>
+	static auto find_root(std::vector<Vertex, Allocator>& parent, Vertex vertex) -> Vertex
+	{
+		Vertex root = vertex;
+		while(parent[root] != root) { root = parent[root]; }
+
+		while(parent[vertex] != root)
+		{
+			const Vertex next = parent[vertex];
+			parent[vertex] = root;
+			vertex = next;
+		}
+		return root;
+	}
+};
+
+/**
+ * @brief Path halving. Every other vertex on the path points to its grandparent.
+ */
+struct PathHalving
+{
+	template<typename Vertex, typename Allocator>
+	static auto find_root(std::vector<Vertex, Allocator>& parent, Vertex vertex) -> Vertex
+	{
+		while(parent[vertex] != vertex)
+		{
+			parent[vertex] = parent[parent[vertex]];
+			vertex = parent[vertex];
+		}
+		return vertex;
+	}
+};
+
+/**
+ * @brief Path splitting. Every vertex on the path points to its grandparent.
+ */
+struct PathSplitting
+{
+	template<typename Vertex, typename Allocator>
+	static auto find_root(std::vector<Vertex, Allocator>& parent, Vertex vertex) -> Vertex
+	{
+		while(parent[vertex] != vertex)
+		{
+			const Vertex next = parent[vertex];
+			parent[vertex] = parent[next];
+			vertex = next;
+		}
+		return vertex;
+	}
+};
+} // namespace UnionFindCPP
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace UnionFindCPP
+{
+constexpr size_t cache_line_size = 64;
+constexpr size_t huge_page_size = size_t{2} << 20U;
+
+namespace detail
+{
+	inline auto huge_pages_flag() -> std::atomic<bool>&
+	{
+		static std::atomic<bool> enabled{false};
+		return enabled;
+	}
+
+#if defined(__linux__)
+	/**
+	 * @brief Map anonymous memory of the given size, a multiple of huge_page_size,
+	 * aligned to huge_page_size and backed by huge pages where possible. Returns nullptr
+	 * on failure.
+	 */
+	inline auto map_huge_pages(size_t bytes) -> void*
+	{
+		constexpr int prot = PROT_READ | PROT_WRITE;
+		constexpr int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_2MB)
+		// explicit huge pages are only available if the administrator reserved them
+		void* reserved
+			= ::mmap(nullptr, bytes, prot, flags | MAP_HUGETLB | MAP_HUGE_2MB, -1, 0);
+		if(reserved != MAP_FAILED) { return reserved; }
+#endif
+		// over-allocate by a huge page and trim, so the range is aligned to it
+		void* addr = ::mmap(nullptr, bytes + huge_page_size, prot, flags, -1, 0);
+		if(addr == MAP_FAILED) { return nullptr; }
+
+		auto* const begin = static_cast<std::byte*>(addr);
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		const auto offset = reinterpret_cast<uintptr_t>(begin) % huge_page_size;
+		const size_t head = (offset == 0) ? 0 : huge_page_size - offset;
+		if(head != 0) { ::munmap(begin, head); }
+		::munmap(begin + head + bytes, huge_page_size - head);
+
+		auto* const aligned = begin + head;
+#if defined(MADV_HUGEPAGE)
+		// transparent huge pages. Ignored if they are disabled in the system
+		::madvise(aligned, bytes, MADV_HUGEPAGE);
+#endif
+		return aligned;
+	}
+#endif
+} // namespace detail
+
+/**
+ * @brief Whether large arrays allocated by HugePageAllocator use huge pages
+ */
+inline auto huge_pages_enabled() -> bool
+{
+	return detail::huge_pages_flag().load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Opt in to huge pages for the large per-vertex and per-edge arrays of decoders
+ * and lattices constructed afterwards.
+ *
+ * Arrays of at least huge_page_size bytes are then backed by explicit 2 MB huge pages
+ * if the system has reserved them, and by transparent huge pages otherwise. Arrays
+ * constructed before the call are not affected, and arrays constructed while huge pages
+ * are disabled use std::allocator. Only supported on Linux. Elsewhere the arrays are
+ * allocated as usual.
+ */
+inline void set_huge_pages_enabled(bool enabled)
+{
+	detail::huge_pages_flag().store(enabled, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Allocator for long-lived arrays indexed by vertex or edge, which are accessed
+ * randomly while clusters grow.
+ *
+ * Whether huge pages are used is fixed when the allocator is constructed, i.e. when the
+ * array is. Without huge pages, memory comes from std::allocator. With them, arrays are
+ * aligned to cache lines, and on Linux arrays of at least huge_page_size bytes are
+ * mapped directly, aligned to huge pages and rounded up to a whole number of them.
+ */
+template<typename T> class HugePageAllocator
+{
+private:
+	template<typename U> friend class HugePageAllocator;
+
+	bool huge_pages_ = huge_pages_enabled();
+
+#if defined(__linux__)
+	[[nodiscard]] constexpr static auto is_large(size_t n) -> bool
+	{
+		return n * sizeof(T) >= huge_page_size;
+	}
+
+	[[nodiscard]] constexpr static auto mapped_bytes(size_t n) -> size_t
+	{
+		return (n * sizeof(T) + huge_page_size - 1) / huge_page_size * huge_page_size;
+	}
+#endif
+
+	constexpr static auto alignment = std::align_val_t{
+		alignof(T) > cache_line_size ? alignof(T) : cache_line_size};
+
+public:
+	using value_type = T;
+	// memory must be released by an allocator of the same kind
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+
+	HugePageAllocator() noexcept = default;
+
+	template<typename U>
+	// NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+	HugePageAllocator(const HugePageAllocator<U>& other) noexcept
+		: huge_pages_{other.huge_pages_}
+	{ }
+
+	[[nodiscard]] auto uses_huge_pages() const noexcept -> bool { return huge_pages_; }
+
+	[[nodiscard]] auto allocate(size_t n) -> T*
+	{
+		if(!huge_pages_) { return std::allocator<T>{}.allocate(n); }
+		if(n > (std::numeric_limits<size_t>::max() - 2 * huge_page_size) / sizeof(T))
+		{
+			throw std::bad_array_new_length();
+		}
+#if defined(__linux__)
+		if(is_large(n))
+		{
+			void* addr = detail::map_huge_pages(mapped_bytes(n));
+			if(addr == nullptr) { throw std::bad_alloc(); }
+			return static_cast<T*>(addr);
+		}
+#endif
+		return static_cast<T*>(::operator new(n * sizeof(T), alignment));
+	}
+
+	void deallocate(T* ptr, size_t n) noexcept
+	{
+		if(!huge_pages_)
+		{
+			std::allocator<T>{}.deallocate(ptr, n);
+			return;
+		}
+#if defined(__linux__)
+		if(is_large(n))
+		{
+			::munmap(ptr, mapped_bytes(n));
+			return;
+		}
+#endif
+		::operator delete(ptr, alignment);
+	}
+
+	template<typename U>
+	auto operator==(const HugePageAllocator<U>& other) const noexcept -> bool
+	{
+		return huge_pages_ == other.huge_pages_;
+	}
+};
+
+/**
+ * @brief Array for per-vertex and per-edge data of large lattices
+ */
+template<typename T> using LargeVector = std::vector<T, HugePageAllocator<T>>;
+} // namespace UnionFindCPP
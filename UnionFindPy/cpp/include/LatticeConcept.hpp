@@ -1,8 +1,11 @@
 #pragma once
+#include "StaticVector.hpp"
 #include "utility.hpp"
 
 #include <array>
 #include <concepts>
+#include <ranges>
+#include <span>
 #include <vector>
 
 namespace UnionFindCPP
@@ -19,11 +22,60 @@ namespace detail
 	};
 
 	template<typename T> concept std_array = is_std_array<T>::value;
+
+	template<typename T> struct is_static_vector : std::false_type
+	{
+	};
+
+	template<typename T, std::size_t N>
+	struct is_static_vector<StaticVector<T, N>> : std::true_type
+	{
+	};
+
+	template<typename T> concept static_vector = is_static_vector<T>::value;
+
+	template<typename T> struct is_index_vector : std::false_type
+	{
+	};
+
+	template<std::unsigned_integral Index, typename Allocator>
+	struct is_index_vector<std::vector<Index, Allocator>> : std::true_type
+	{
+	};
+
+	template<typename T> struct is_basic_neighbor : std::false_type
+	{
+	};
+
+	template<typename Index>
+	struct is_basic_neighbor<BasicNeighbor<Index>> : std::true_type
+	{
+	};
+
+	template<typename T> struct lattice_index
+	{
+		using type = uint32_t;
+	};
+
+	template<typename T>
+	requires requires { typename T::Index; }
+	struct lattice_index<T>
+	{
+		using type = typename T::Index;
+	};
 } // namespace detail
 
+/**
+ * @brief Unsigned integer type of the vertices and edge indices of a lattice. Lattices
+ * choose it with a member type Index (e.g. uint16_t for small codes), and it is uint32_t
+ * otherwise. Decoder uses the same type for its arrays over vertices and edges.
+ */
+template<typename T> using lattice_index_t = typename detail::lattice_index<T>::type;
+
 template<typename T>
-concept vertex_connections_result
-	= std::convertible_to<T, std::vector<uint32_t>> || detail::std_array<T>;
+concept vertex_connections_result = std::convertible_to<T, std::vector<uint32_t>>
+	|| detail::is_index_vector<T>::value || detail::std_array<T>
+	|| detail::static_vector<T>;
 
 /**
  * @brief Define LatticeConcept that custom Lattice classes should follow.
@@ -47,4 +99,44 @@ concept LatticeConcept = requires(const T lattice, uint32_t vertex, Edge e)
 		lattice.edge_idx(e)
 		} -> std::convertible_to<uint32_t>;
 };
+
+template<typename T>
+concept neighbor_range = std::ranges::input_range<T>
+	&& detail::is_basic_neighbor<std::ranges::range_value_t<T>>::value;
+
+/**
+ * @brief A lattice that can also list the neighbors of a vertex together with the
+ * indices of the connecting edges, e.g. as a std::span<const Neighbor>. Decoder
+ * uses vertex_neighbors instead of calling edge_idx for each neighbor when a lattice
+ * provides it.
+ */
+template<typename T>
+concept LatticeWithNeighborEdges
+	= LatticeConcept<T> && requires(const T lattice, uint32_t vertex)
+{
+	{
+		lattice.vertex_neighbors(vertex)
+		} -> neighbor_range;
+};
+
+/**
+ * @brief A lattice whose vertices and edges are numbered differently from the
+ * syndromes and corrections of users, e.g. reordered for cache locality. Decoder
+ * converts the vertices of syndromes with internal_vertex, and those of corrections
+ * with original_vertex and original_edge_idx.
+ */
+template<typename T>
+concept LatticeWithInternalOrder
+	= LatticeConcept<T> && requires(const T lattice, uint32_t vertex, uint32_t edge_idx)
+{
+	{
+		lattice.internal_vertex(vertex)
+		} -> std::convertible_to<uint32_t>;
+	{
+		lattice.original_vertex(vertex)
+		} -> std::convertible_to<uint32_t>;
+	{
+		lattice.original_edge_idx(edge_idx)
+		} -> std::convertible_to<uint32_t>;
+};
 } // namespace UnionFindCPP
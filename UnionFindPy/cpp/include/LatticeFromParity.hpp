@@ -1,89 +1,535 @@
 #pragma once
 
+#include "HugePageAllocator.hpp"
+#include "MappedFile.hpp"
+#include "ParallelFor.hpp"
+#include "VertexOrder.hpp"
 #include "utility.hpp"
 
 #include "tsl/robin_map.h"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <thread>
+#include <type_traits>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
-#include <iostream>
-
 namespace UnionFindCPP
 {
 /**
  * This class implements LatticeConcept using the input of sparse parity matrix.
+ *
+ * The graph is stored in CSR format: the neighbors of vertex v, each with the index of
+ * the connecting edge, are neighbors_[offsets_[v]] ... neighbors_[offsets_[v+1]-1].
+ *
+ * A built lattice can be saved to a binary file with save() and mapped back with
+ * load(). The arrays of a loaded lattice point directly into the read-only mapping, so
+ * processes loading the same file share its memory. Copies of a lattice share the
+ * arrays as well.
+ *
+ * The vertices and edges of a lattice returned by reordered() are renumbered for cache
+ * locality. All methods of the lattice then use the internal numbering, and
+ * internal_vertex(), original_vertex() and original_edge_idx() convert it from and to
+ * the rows and columns of the parity matrix. Decoder applies the conversion itself, so
+ * its syndromes and corrections always use the original numbering.
+ *
+ * @tparam IndexType unsigned integer type of vertices, edge indices and CSR offsets.
+ * uint16_t halves the memory of small codes compared to the default uint32_t, and
+ * uint64_t allows lattices with more than 2^31 edges. Decoder uses the same type for
+ * its own arrays. APIs taking or returning Edge are limited to 32-bit vertices.
  */
-class LatticeFromParity
+template<std::unsigned_integral IndexType> class BasicLatticeFromParity
 {
+public:
+	using Index = IndexType;
+	using Neighbor = BasicNeighbor<Index>;
+
 private:
-	uint32_t num_vertices_;
-	uint32_t num_edges_;
-
-	/* connectivity of vertices (parities). Length num_parities */
-	std::vector<std::vector<uint32_t>> vertex_connections_;
-	tsl::robin_map<Edge, uint32_t> edge_idx_;
-
-	static auto construct_qubit_associated_parities(uint32_t num_parities,
-													uint32_t num_qubits, int* col_indices,
-													const int* indptr)
-		-> std::vector<std::vector<uint32_t>>
-	{
-		/**
-		 * key: qubit_idx, value: vector of all connected vertices (parities). Length
-		 * num_qubits
-		 */
-		std::vector<std::vector<uint32_t>> qubit_associated_parities(num_qubits);
-		for(uint32_t p_idx = 0; p_idx < num_parities; ++p_idx)
-		{
-			// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-			for(uint32_t idx = indptr[p_idx]; idx < indptr[p_idx + 1]; ++idx)
-			{
-				// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-				qubit_associated_parities[col_indices[idx]].push_back(p_idx);
-			}
+	constexpr static Index no_vertex = std::numeric_limits<Index>::max();
+
+	constexpr static std::array<char, 8> file_magic{'U', 'F', 'L', 'A',
+													'T', 'T', 'I', 'C'};
+	constexpr static uint32_t file_version = 3;
+	constexpr static uint32_t byte_order_mark = 0x01020304;
+
+	/*
+	 * Layout of a saved lattice: FileHeader, offsets_, padding to 8 bytes, neighbors_,
+	 * original_vertices_, internal_vertices_ and original_edges_. All arrays have
+	 * elements of index_size bytes.
+	 */
+	struct FileHeader
+	{
+		std::array<char, 8> magic;
+		uint32_t version;
+		uint32_t byte_order_mark;
+		/* sizeof(Index) of the lattice that wrote the file */
+		uint32_t index_size;
+		uint32_t repetitions;
+		/* Number of layers if the file holds a layer of LatticeRepeated, 0 otherwise */
+		uint32_t layer_repetitions;
+		uint32_t reserved;
+		uint64_t num_vertices;
+		uint64_t num_edges;
+		uint64_t num_neighbors;
+		/* num_vertices and num_edges if the lattice is reordered, 0 otherwise */
+		uint64_t num_ordered_vertices;
+		uint64_t num_ordered_edges;
+	};
+	static_assert(std::is_trivially_copyable_v<Neighbor>
+				  && sizeof(Neighbor) == 2 * sizeof(Index));
+
+	Index num_vertices_;
+	Index num_edges_;
+	uint32_t repetitions_ = 1;
+
+	/* Owner of the memory offsets_ and neighbors_ point to */
+	std::shared_ptr<const void> storage_;
+	/* Length num_vertices + 1 */
+	std::span<const Index> offsets_;
+	std::span<const Neighbor> neighbors_;
+	/* index: internal vertex, original vertex and internal edge index, respectively.
+	 * Empty if the lattice is not reordered */
+	std::span<const Index> original_vertices_;
+	std::span<const Index> internal_vertices_;
+	std::span<const Index> original_edges_;
+
+	BasicLatticeFromParity() = default;
+
+	friend class LatticeRepeated;
+
+	constexpr static auto neighbors_position(uint64_t num_vertices) -> size_t
+	{
+		constexpr size_t align = alignof(uint64_t);
+		const size_t offsets_end
+			= sizeof(FileHeader) + sizeof(Index) * (num_vertices + 1);
+		return (offsets_end + align - 1) / align * align;
+	}
+
+	/* Storage of a lattice constructed from a parity matrix */
+	struct Storage
+	{
+		LargeVector<Index> offsets;
+		LargeVector<Neighbor> neighbors;
+		LargeVector<Index> original_vertices;
+		LargeVector<Index> internal_vertices;
+		LargeVector<Index> original_edges;
+	};
+
+	/* Matrices with fewer nonzero elements per thread are built by fewer threads */
+	constexpr static size_t min_nonzeros_per_thread = size_t{1} << 16U;
+
+	[[nodiscard]] static auto build_threads(size_t num_threads, size_t num_nonzeros)
+		-> size_t
+	{
+		if(num_threads == 0)
+		{
+			num_threads = std::max(1U, std::thread::hardware_concurrency());
+		}
+		return std::clamp<size_t>(num_nonzeros / min_nonzeros_per_thread, 1, num_threads);
+	}
+
+	/**
+	 * @brief Record that parity p contains the qubit whose two smallest parities are
+	 * packed in parities as (first << 32) | second. If concurrent is true, the update is
+	 * atomic so that different threads can add parities of the same qubit.
+	 */
+	template<bool concurrent> static void add_parity(uint64_t& parities, uint32_t p)
+	{
+		const auto updated = [p](uint64_t current) -> uint64_t
+		{
+			const auto first = static_cast<uint32_t>(current >> 32U);
+			const auto second = static_cast<uint32_t>(current);
+			if(p < first) { return (uint64_t{p} << 32U) | first; }
+			if(p < second) { return (uint64_t{first} << 32U) | p; }
+			return current;
+		};
+		if constexpr(!concurrent) { parities = updated(parities); }
+		else
+		{
+			std::atomic_ref<uint64_t> ref(parities);
+			uint64_t current = ref.load(std::memory_order_relaxed);
+			while(!ref.compare_exchange_weak(current, updated(current),
+											 std::memory_order_relaxed))
+			{ }
 		}
-		return qubit_associated_parities;
 	}
 
-	static auto construct_edge_idx(
-		uint32_t num_qubits,
-		const std::vector<std::vector<uint32_t>>& qubit_associated_parities)
-		-> tsl::robin_map<Edge, uint32_t>
+	/**
+	 * @brief Construct the CSR arrays of the graph of a parity matrix. Each qubit
+	 * (column) must be contained in two parities (rows); further parities are ignored.
+	 * If several qubits connect the same pair of parities, only the one with the
+	 * smallest index becomes an edge. Neighbors of a parity are listed in the order of
+	 * col_indices.
+	 *
+	 * The matrix is read in four linear passes over its rows, each split among
+	 * num_threads threads. Rows and columns are handled as uint32_t, which the
+	 * constructors check to fit in Index.
+	 */
+	template<std::integral ColIndex, std::integral IndPtr>
+	static auto construct_layer(uint32_t num_parities, uint32_t num_qubits,
+								const ColIndex* col_indices, const IndPtr* indptr,
+								size_t num_threads) -> Storage
 	{
-		tsl::robin_map<Edge, uint32_t> edge_idx;
-		for(uint32_t q_idx = 0; q_idx < num_qubits; ++q_idx)
+		// NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		const auto row = [col_indices, indptr](uint32_t p_idx)
+		{
+			return std::span<const ColIndex>(col_indices + indptr[p_idx],
+											 col_indices + indptr[p_idx + 1]);
+		};
+		num_threads
+			= build_threads(num_threads, static_cast<size_t>(indptr[num_parities]));
+		// NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+		/* the two smallest parities of each qubit. index: qubit */
+		std::vector<uint64_t> parities(num_qubits, std::numeric_limits<uint64_t>::max());
+		parallel_for(
+			num_threads, num_parities,
+			[&](uint32_t begin, uint32_t end)
+			{
+				const auto add_parities = [&]<bool concurrent>()
+				{
+					for(uint32_t p_idx = begin; p_idx < end; ++p_idx)
+					{
+						for(const auto q_idx : row(p_idx))
+						{
+							add_parity<concurrent>(parities[q_idx], p_idx);
+						}
+					}
+				};
+				// atomics are only needed if rows are split among threads
+				if(num_threads > 1) { add_parities.template operator()<true>(); }
+				else { add_parities.template operator()<false>(); }
+			});
+		const auto first = [&parities](uint32_t q_idx)
+		{ return static_cast<uint32_t>(parities[q_idx] >> 32U); };
+		const auto second = [&parities](uint32_t q_idx)
+		{ return static_cast<uint32_t>(parities[q_idx]); };
+
+		const auto has_one_parity = [](uint64_t qubit_parities)
+		{
+			return static_cast<uint32_t>(qubit_parities)
+				   == std::numeric_limits<uint32_t>::max();
+		};
+		if(std::any_of(parities.begin(), parities.end(), has_one_parity))
 		{
-			const auto& q_parities = qubit_associated_parities[q_idx];
-			auto edge = Edge{q_parities[0], q_parities[1]};
-			auto iter = edge_idx.find(edge);
+			throw std::invalid_argument("Each qubit must be contained in two parities");
+		}
 
-			if(iter == edge_idx.end()) // first appear
+		/* Whether each qubit is an edge. Qubits sharing a first parity are compared in
+		 * the row of that parity */
+		std::vector<uint8_t> is_edge(num_qubits, 0);
+		parallel_for(
+			num_threads, num_parities,
+			[&](uint32_t begin, uint32_t end)
 			{
-				edge_idx.emplace(edge, q_idx);
+				/* (second parity, qubit) of qubits whose first parity is p_idx */
+				std::vector<std::pair<uint32_t, uint32_t>> group;
+				for(uint32_t p_idx = begin; p_idx < end; ++p_idx)
+				{
+					group.clear();
+					for(const auto q_idx : row(p_idx))
+					{
+						const auto q = static_cast<uint32_t>(q_idx);
+						if(first(q) == p_idx) { group.emplace_back(second(q), q); }
+					}
+					std::sort(group.begin(), group.end());
+					for(size_t idx = 0; idx < group.size(); ++idx)
+					{
+						if(idx == 0 || group[idx].first != group[idx - 1].first)
+						{
+							is_edge[group[idx].second] = 1;
+						}
+					}
+				}
+			});
+
+		const auto for_each_neighbor = [&](uint32_t p_idx, auto&& func)
+		{
+			for(const auto q_idx : row(p_idx))
+			{
+				const auto q = static_cast<uint32_t>(q_idx);
+				if(is_edge[q] == 0) { continue; }
+				if(first(q) == p_idx)
+				{
+					func(Neighbor{static_cast<Index>(second(q)), static_cast<Index>(q)});
+				}
+				else if(second(q) == p_idx)
+				{
+					func(Neighbor{static_cast<Index>(first(q)), static_cast<Index>(q)});
+				}
 			}
+		};
+
+		Storage storage;
+		auto& offsets = storage.offsets;
+		offsets.assign(size_t{num_parities} + 1, 0);
+		parallel_for(
+			num_threads, num_parities,
+			[&](uint32_t begin, uint32_t end)
+			{
+				for(uint32_t p_idx = begin; p_idx < end; ++p_idx)
+				{
+					for_each_neighbor(p_idx, [&](const Neighbor& /*neighbor*/)
+									  { ++offsets[p_idx + 1]; });
+				}
+			});
+		std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+		storage.neighbors.resize(offsets.back());
+		parallel_for(
+			num_threads, num_parities,
+			[&](uint32_t begin, uint32_t end)
+			{
+				for(uint32_t p_idx = begin; p_idx < end; ++p_idx)
+				{
+					auto pos = offsets[p_idx];
+					for_each_neighbor(p_idx, [&](const Neighbor& neighbor)
+									  { storage.neighbors[pos++] = neighbor; });
+				}
+			});
+		return storage;
+	}
+
+	/**
+	 * @brief Construct the CSR arrays of a layer repeated in time. Vertex u of layer d
+	 * is connected to the same vertex of layer d + 1 by a timelike edge.
+	 */
+	static auto construct_repeated(const Storage& layer, uint32_t layer_num_qubits,
+								   uint32_t repetitions, size_t num_threads) -> Storage
+	{
+		const auto layer_vertex_size = static_cast<Index>(layer.offsets.size() - 1);
+		const auto num_vertices = static_cast<Index>(layer_vertex_size * repetitions);
+		const auto stride = static_cast<Index>(layer_vertex_size + layer_num_qubits);
+
+		Storage storage;
+		auto& offsets = storage.offsets;
+		offsets.resize(size_t{num_vertices} + 1);
+		offsets[0] = 0;
+		for(Index v = 0; v < num_vertices; ++v)
+		{
+			const Index depth = v / layer_vertex_size;
+			const Index u = v % layer_vertex_size;
+			offsets[v + 1] = static_cast<Index>(
+				offsets[v] + (layer.offsets[u + 1] - layer.offsets[u])
+				+ static_cast<Index>(depth > 0)
+				+ static_cast<Index>(depth + 1U < repetitions));
 		}
-		return edge_idx;
+
+		storage.neighbors.resize(offsets.back());
+		num_threads = build_threads(num_threads, storage.neighbors.size());
+		parallel_for(
+			num_threads, num_vertices,
+			[&](Index begin, Index end)
+			{
+				const auto make_neighbor = [](auto vertex, auto edge_idx)
+				{
+					return Neighbor{static_cast<Index>(vertex),
+									static_cast<Index>(edge_idx)};
+				};
+				for(Index v = begin; v < end; ++v)
+				{
+					const Index depth = v / layer_vertex_size;
+					const Index u = v % layer_vertex_size;
+					auto pos = offsets[v];
+					// spacelike edges
+					for(auto idx = layer.offsets[u]; idx < layer.offsets[u + 1]; ++idx)
+					{
+						const auto& neighbor = layer.neighbors[idx];
+						storage.neighbors[pos++]
+							= make_neighbor(neighbor.vertex + depth * layer_vertex_size,
+											neighbor.edge_idx + depth * stride);
+					}
+					// timelike edges
+					const auto timelike_idx
+						= static_cast<Index>(layer_num_qubits + u + depth * stride);
+					if(depth > 0)
+					{
+						storage.neighbors[pos++]
+							= make_neighbor(v - layer_vertex_size, timelike_idx - stride);
+					}
+					if(depth + 1U < repetitions)
+					{
+						storage.neighbors[pos++]
+							= make_neighbor(v + layer_vertex_size, timelike_idx);
+					}
+				}
+			});
+		return storage;
+	}
+
+	/**
+	 * @brief Point the arrays of the lattice to the given storage
+	 */
+	void set_storage(Storage&& storage)
+	{
+		auto shared = std::make_shared<Storage>(std::move(storage));
+		offsets_ = shared->offsets;
+		neighbors_ = shared->neighbors;
+		original_vertices_ = shared->original_vertices;
+		internal_vertices_ = shared->internal_vertices;
+		original_edges_ = shared->original_edges;
+		storage_ = std::move(shared);
+	}
+
+	/**
+	 * @brief Write the lattice to a file in the layout of FileHeader
+	 */
+	void write_file(const std::string& path, uint32_t layer_repetitions) const
+	{
+		FileHeader header{};
+		header.magic = file_magic;
+		header.version = file_version;
+		header.byte_order_mark = byte_order_mark;
+		header.index_size = sizeof(Index);
+		header.num_vertices = num_vertices_;
+		header.num_edges = num_edges_;
+		header.repetitions = repetitions_;
+		header.layer_repetitions = layer_repetitions;
+		header.num_neighbors = neighbors_.size();
+		header.num_ordered_vertices = original_vertices_.size();
+		header.num_ordered_edges = original_edges_.size();
+
+		std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+		if(!fout) { throw std::runtime_error("Cannot open file " + path); }
+
+		const auto write = [&fout](const void* data, size_t size)
+		{
+			fout.write(static_cast<const char*>(data),
+					   static_cast<std::streamsize>(size));
+		};
+		write(&header, sizeof(FileHeader));
+		write(offsets_.data(), offsets_.size_bytes());
+		const std::array<char, alignof(uint64_t)> padding{};
+		write(padding.data(), neighbors_position(num_vertices_) - sizeof(FileHeader)
+								  - offsets_.size_bytes());
+		write(neighbors_.data(), neighbors_.size_bytes());
+		write(original_vertices_.data(), original_vertices_.size_bytes());
+		write(internal_vertices_.data(), internal_vertices_.size_bytes());
+		write(original_edges_.data(), original_edges_.size_bytes());
+
+		if(!fout) { throw std::runtime_error("Cannot write file " + path); }
 	}
 
 	/**
-	 * @brief Use edge_idx_ to construct vertex_connections_
+	 * @brief Map a lattice file and return the lattice with the layer_repetitions field
+	 * of the file
 	 */
-	void construct_vertex_connections_from_edges()
+	[[nodiscard]] static auto read_file(const std::string& path)
+		-> std::pair<BasicLatticeFromParity, uint32_t>
 	{
-		vertex_connections_.resize(num_vertices_);
-		for(const auto& [edge, qidx] : edge_idx_)
+		auto file = map_file(path);
+
+		FileHeader header{};
+		if(file.size < sizeof(FileHeader))
+		{
+			throw std::invalid_argument(path + " is not a lattice file");
+		}
+		std::memcpy(&header, file.data.get(), sizeof(FileHeader));
+		if(header.magic != file_magic)
+		{
+			throw std::invalid_argument(path + " is not a lattice file");
+		}
+		if(header.version != file_version)
+		{
+			throw std::invalid_argument("Unsupported version of lattice file "
+										+ std::to_string(header.version));
+		}
+		if(header.byte_order_mark != byte_order_mark)
+		{
+			throw std::invalid_argument("Lattice file has a different byte order");
+		}
+		if(header.index_size != sizeof(Index))
+		{
+			throw std::invalid_argument("Lattice file " + path + " has indices of "
+										+ std::to_string(header.index_size)
+										+ " bytes, but " + std::to_string(sizeof(Index))
+										+ " bytes are expected");
+		}
+		const Index num_vertices = checked_size(header.num_vertices);
+		const Index num_edges = checked_size(header.num_edges);
+
+		const size_t neighbors_pos = neighbors_position(num_vertices);
+		const size_t order_pos = neighbors_pos + sizeof(Neighbor) * header.num_neighbors;
+		const size_t order_size = sizeof(Index)
+								  * (2 * header.num_ordered_vertices
+									 + header.num_ordered_edges);
+		const bool valid_order
+			= (header.num_ordered_vertices == 0)
+				  ? (header.num_ordered_edges == 0)
+				  : (header.num_ordered_vertices == num_vertices
+					 && header.num_ordered_edges == num_edges);
+		if(!valid_order || file.size != order_pos + order_size)
 		{
-			const auto [u, v] = edge;
-			vertex_connections_[u].emplace_back(v);
-			vertex_connections_[v].emplace_back(u);
+			throw std::invalid_argument("Size of lattice file " + path
+										+ " does not match its header");
 		}
+
+		BasicLatticeFromParity lattice;
+		lattice.num_vertices_ = num_vertices;
+		lattice.num_edges_ = num_edges;
+		lattice.repetitions_ = header.repetitions;
+		// NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+		lattice.offsets_ = std::span<const Index>(
+			reinterpret_cast<const Index*>(file.data.get() + sizeof(FileHeader)),
+			size_t{num_vertices} + 1);
+		lattice.neighbors_ = std::span<const Neighbor>(
+			reinterpret_cast<const Neighbor*>(file.data.get() + neighbors_pos),
+			header.num_neighbors);
+		const auto* order = reinterpret_cast<const Index*>(file.data.get() + order_pos);
+		lattice.original_vertices_
+			= std::span<const Index>(order, header.num_ordered_vertices);
+		lattice.internal_vertices_ = std::span<const Index>(
+			order + header.num_ordered_vertices, header.num_ordered_vertices);
+		lattice.original_edges_ = std::span<const Index>(
+			order + 2 * header.num_ordered_vertices, header.num_ordered_edges);
+		// NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+		lattice.storage_ = std::move(file.data);
+
+		// the decoder indexes its arrays with these without further checks
+		const auto& offsets = lattice.offsets_;
+		const bool valid_offsets
+			= offsets.front() == 0 && offsets.back() == lattice.neighbors_.size()
+			  && std::is_sorted(offsets.begin(), offsets.end());
+		const bool valid_neighbors = std::all_of(
+			lattice.neighbors_.begin(), lattice.neighbors_.end(),
+			[num_vertices, num_edges](const Neighbor& neighbor)
+			{ return neighbor.vertex < num_vertices && neighbor.edge_idx < num_edges; });
+		if(!valid_offsets || !valid_neighbors)
+		{
+			throw std::invalid_argument("Lattice file " + path + " is corrupted");
+		}
+		return {std::move(lattice), header.layer_repetitions};
 	}
 
 public:
+	/**
+	 * @brief Check that a lattice with the given number of vertices or edges fits in
+	 * Index, including offsets_ which counts each edge twice
+	 */
+	static auto checked_size(uint64_t size) -> Index
+	{
+		if(size > std::numeric_limits<Index>::max() / 2)
+		{
+			throw std::invalid_argument("Lattice is too large for "
+										+ std::to_string(8 * sizeof(Index))
+										+ "-bit indices");
+		}
+		return static_cast<Index>(size);
+	}
+
 	/**
 	 * @brief construct a Lattice class from a given parity matrix (CSR format)
 	 *
@@ -93,95 +539,238 @@ public:
 	 * matrix
 	 * @param col_indices indices[idx] indicate the column index of the element data[idx]
 	 * @param indptr indptr[row+1]-indptr[row] indicate the number of elements in the row
+	 *
+	 * col_indices and indptr can be arrays of any integer type, e.g. int32 or int64
+	 * arrays of scipy, and are read without conversion.
 	 */
-	LatticeFromParity(uint32_t num_parities, uint32_t num_qubits, int* col_indices,
-					  int* indptr)
-		: num_vertices_{num_parities}, num_edges_{num_qubits}
-	{
-		auto qubit_associated_parities = construct_qubit_associated_parities(
-			num_parities, num_qubits, col_indices, indptr);
+	template<std::integral ColIndex, std::integral IndPtr>
+	BasicLatticeFromParity(uint32_t num_parities, uint32_t num_qubits,
+						   const ColIndex* col_indices, const IndPtr* indptr)
+		: BasicLatticeFromParity(num_parities, num_qubits, col_indices, indptr, 1, 0)
+	{ }
 
-		edge_idx_ = construct_edge_idx(num_qubits, qubit_associated_parities);
-		construct_vertex_connections_from_edges();
-	}
-
-	LatticeFromParity(uint32_t layer_vertex_size, uint32_t layer_num_qubits,
-					  int* col_indices, int* indptr, uint32_t repetitions)
-		: num_vertices_{layer_vertex_size * repetitions},
-		  num_edges_{layer_num_qubits * repetitions
-					 + layer_vertex_size * (repetitions - 1)}
+	template<std::integral ColIndex, std::integral IndPtr>
+	BasicLatticeFromParity(uint32_t layer_vertex_size, uint32_t layer_num_qubits,
+						   const ColIndex* col_indices, const IndPtr* indptr,
+						   uint32_t repetitions)
+		: BasicLatticeFromParity(layer_vertex_size, layer_num_qubits, col_indices,
+								 indptr, repetitions, 0)
 	{
 		if(repetitions < 2)
 		{
 			throw std::invalid_argument("Repetition must be greater than or equal to 2.");
 		}
+	}
 
-		auto qubit_associated_parities = construct_qubit_associated_parities(
-			layer_vertex_size, layer_num_qubits, col_indices, indptr);
-		auto layer_edge_idx
-			= construct_edge_idx(layer_num_qubits, qubit_associated_parities);
+	/**
+	 * @brief Construct a lattice using the given number of threads
+	 *
+	 * @param repetitions number of layers. 1 constructs the lattice of the parity matrix
+	 * itself.
+	 * @param num_threads number of threads used for construction. If 0, the number of
+	 * hardware threads is used. Small matrices are always built by fewer threads.
+	 */
+	template<std::integral ColIndex, std::integral IndPtr>
+	BasicLatticeFromParity(uint32_t layer_vertex_size, uint32_t layer_num_qubits,
+						   const ColIndex* col_indices, const IndPtr* indptr,
+						   uint32_t repetitions, size_t num_threads)
+		: num_vertices_{checked_size(uint64_t{layer_vertex_size} * repetitions)},
+		  num_edges_{checked_size(uint64_t{layer_num_qubits} * repetitions
+								  + uint64_t{layer_vertex_size}
+										* (std::max(repetitions, 1U) - 1))},
+		  repetitions_{repetitions}
+	{
+		if(repetitions < 1)
+		{
+			throw std::invalid_argument("Repetition must be greater than or equal to 1.");
+		}
 
-		// Construct edge_idx_
-		edge_idx_.reserve(num_edges_);
-		// Add spacelike edges
-		for(uint32_t depth = 0; depth < repetitions; ++depth)
+		auto layer = construct_layer(layer_vertex_size, layer_num_qubits, col_indices,
+									 indptr, num_threads);
+		if(repetitions == 1) { set_storage(std::move(layer)); }
+		else
 		{
-			for(const auto& [layer_edge, q_idx] : layer_edge_idx)
-			{
-				auto edge = Edge{layer_edge.u + depth * layer_vertex_size,
-								 layer_edge.v + depth * layer_vertex_size};
+			set_storage(
+				construct_repeated(layer, layer_num_qubits, repetitions, num_threads));
+		}
+	}
+
+	/**
+	 * @brief Copy of the lattice whose vertices are renumbered in the given order. Edges
+	 * are then numbered in the order of their smaller vertex, so that the edges of
+	 * nearby vertices are also nearby. Reordering an already reordered lattice keeps the
+	 * conversion to the original numbering.
+	 */
+	[[nodiscard]] auto reordered(VertexOrder order) const -> BasicLatticeFromParity
+	{
+		if(order == VertexOrder::Original) { return *this; }
 
-				edge_idx_.emplace(edge,
-								  q_idx + depth * (layer_vertex_size + layer_num_qubits));
+		/* current index of each vertex in the new order, and its inverse */
+		const auto current = compute_vertex_order(offsets_, neighbors_, order);
+		std::vector<Index> new_index(num_vertices_);
+		for(Index v = 0; v < num_vertices_; ++v) { new_index[current[v]] = v; }
+
+		/* index: current edge index */
+		std::vector<Index> new_edge_idx(num_edges_, no_vertex);
+		Index num_new_edges = 0;
+		for(Index v = 0; v < num_vertices_; ++v)
+		{
+			for(const auto& neighbor : vertex_neighbors(current[v]))
+			{
+				if(new_index[neighbor.vertex] > v)
+				{
+					new_edge_idx[neighbor.edge_idx] = num_new_edges++;
+				}
 			}
 		}
+		// qubits parallel to another one are not in the graph and come last
+		for(auto& idx : new_edge_idx)
+		{
+			if(idx == no_vertex) { idx = num_new_edges++; }
+		}
 
-		// Add timelike edges
-		for(uint32_t depth = 0; depth < repetitions - 1; ++depth)
+		Storage storage;
+		storage.offsets.resize(size_t{num_vertices_} + 1);
+		storage.offsets[0] = 0;
+		storage.neighbors.reserve(neighbors_.size());
+		storage.original_vertices.resize(num_vertices_);
+		storage.internal_vertices.resize(num_vertices_);
+		for(Index v = 0; v < num_vertices_; ++v)
 		{
-			for(int layer_vertex_idx = 0; layer_vertex_idx < layer_vertex_size;
-				++layer_vertex_idx)
+			for(const auto& neighbor : vertex_neighbors(current[v]))
 			{
-				auto edge = Edge{depth * layer_vertex_size + layer_vertex_idx,
-								 (depth + 1) * layer_vertex_size + layer_vertex_idx};
-				edge_idx_.emplace(edge,
-								  layer_vertex_idx + layer_num_qubits
-									  + (layer_num_qubits + layer_vertex_size) * depth);
+				storage.neighbors.push_back(Neighbor{new_index[neighbor.vertex],
+													 new_edge_idx[neighbor.edge_idx]});
 			}
+			storage.offsets[v + 1] = static_cast<Index>(storage.neighbors.size());
+
+			const Index original = original_vertex(current[v]);
+			storage.original_vertices[v] = original;
+			storage.internal_vertices[original] = v;
+		}
+		storage.original_edges.resize(num_edges_);
+		for(Index e = 0; e < num_edges_; ++e)
+		{
+			storage.original_edges[new_edge_idx[e]] = original_edge_idx(e);
 		}
 
-		// Construct vertex_connections_
-		construct_vertex_connections_from_edges();
+		BasicLatticeFromParity res;
+		res.num_vertices_ = num_vertices_;
+		res.num_edges_ = num_edges_;
+		res.repetitions_ = repetitions_;
+		res.set_storage(std::move(storage));
+		return res;
 	}
 
-	[[nodiscard]] auto vertex_connections(uint32_t v) const
-		-> const std::vector<uint32_t>&
+	/**
+	 * @brief Internal index of the vertex given by the row of the parity matrix
+	 */
+	[[nodiscard]] auto internal_vertex(Index v) const -> Index
 	{
-		return vertex_connections_[v];
+		return internal_vertices_.empty() ? v : internal_vertices_[v];
 	}
 
-	[[nodiscard]] auto vertex_connection_count(int vertex) const -> uint32_t
+	/**
+	 * @brief Row of the parity matrix of the vertex with the given internal index
+	 */
+	[[nodiscard]] auto original_vertex(Index v) const -> Index
 	{
-		return static_cast<int>(vertex_connections_[vertex].size());
+		return original_vertices_.empty() ? v : original_vertices_[v];
 	}
 
-	[[nodiscard]] inline auto edge_idx(const Edge& edge) const -> uint32_t
+	/**
+	 * @brief Column of the parity matrix of the edge with the given internal index
+	 */
+	[[nodiscard]] auto original_edge_idx(Index edge_idx) const -> Index
+	{
+		return original_edges_.empty() ? edge_idx : original_edges_[edge_idx];
+	}
+
+	/**
+	 * @brief Neighbors of the vertex together with the indices of the connecting edges
+	 */
+	[[nodiscard]] auto vertex_neighbors(Index v) const -> std::span<const Neighbor>
+	{
+		return neighbors_.subspan(offsets_[v], offsets_[v + 1] - offsets_[v]);
+	}
+
+	[[nodiscard]] auto vertex_connections(Index v) const -> std::vector<Index>
+	{
+		std::vector<Index> res;
+		res.reserve(vertex_connection_count(v));
+		for(const auto& neighbor : vertex_neighbors(v))
+		{
+			res.emplace_back(neighbor.vertex);
+		}
+		return res;
+	}
+
+	[[nodiscard]] auto vertex_connection_count(Index vertex) const -> Index
+	{
+		return static_cast<Index>(offsets_[vertex + 1] - offsets_[vertex]);
+	}
+
+	/**
+	 * @brief Index of the edge. Cost is linear in the degree of edge.u.
+	 */
+	[[nodiscard]] inline auto edge_idx(const Edge& edge) const -> Index
 	{
-		return edge_idx_.at(edge);
+		for(const auto& neighbor : vertex_neighbors(edge.u))
+		{
+			if(neighbor.vertex == edge.v) { return neighbor.edge_idx; }
+		}
+		throw std::out_of_range("The given edge is not in the lattice");
 	}
 
-	[[nodiscard]] inline auto num_edges() const -> uint32_t { return num_edges_; }
+	[[nodiscard]] inline auto num_edges() const -> Index { return num_edges_; }
+
+	[[nodiscard]] inline auto num_vertices() const -> Index { return num_vertices_; }
+
+	/**
+	 * @brief Number of layers given to the constructor, 1 if the lattice is not repeated
+	 */
+	[[nodiscard]] inline auto repetitions() const -> uint32_t { return repetitions_; }
 
-	[[nodiscard]] inline auto num_vertices() const -> uint32_t { return num_vertices_; }
+	/**
+	 * @brief Save the lattice to a binary file that can be loaded with load()
+	 */
+	void save(const std::string& path) const { write_file(path, 0); }
 
-	[[nodiscard]] inline auto
-	edge_idx_all() const& -> const tsl::robin_map<Edge, uint32_t>&
+	/**
+	 * @brief Load a lattice saved with save(). The file is mapped read-only and used
+	 * without copying.
+	 */
+	[[nodiscard]] static auto load(const std::string& path) -> BasicLatticeFromParity
 	{
-		return edge_idx_;
+		auto [lattice, layer_repetitions] = read_file(path);
+		if(layer_repetitions != 0)
+		{
+			throw std::invalid_argument(path + " holds a layer of LatticeRepeated");
+		}
+		return std::move(lattice);
 	}
-	[[nodiscard]] inline auto edge_idx_all() && -> tsl::robin_map<Edge, uint32_t>
+
+	/**
+	 * @brief All edges of the lattice and their indices
+	 */
+	[[nodiscard]] auto edge_idx_all() const -> tsl::robin_map<Edge, Index>
+	requires(sizeof(Index) <= sizeof(uint32_t))
 	{
-		return edge_idx_;
+		tsl::robin_map<Edge, Index> res;
+		res.reserve(neighbors_.size() / 2);
+		for(Index u = 0; u < num_vertices_; ++u)
+		{
+			for(const auto& neighbor : vertex_neighbors(u))
+			{
+				if(u < neighbor.vertex)
+				{
+					res.emplace(Edge{u, neighbor.vertex}, neighbor.edge_idx);
+				}
+			}
+		}
+		return res;
 	}
 };
+
+using LatticeFromParity = BasicLatticeFromParity<uint32_t>;
 } // namespace UnionFindCPP
@@ -0,0 +1,299 @@
+#pragma once
+#include "LatticeFromParity.hpp"
+#include "utility.hpp"
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace UnionFindCPP
+{
+/**
+ * @brief Lattice of repeated noisy measurements built from a single layer.
+ *
+ * Vertices, edges and edge indices are the same as those of LatticeFromParity
+ * constructed with repetitions: vertex v is the vertex v % V of layer v / V, and layer
+ * d has the spacelike edges q + d * (V + Q) and the timelike edges Q + u + d * (V + Q)
+ * connecting vertex u to the next layer, where V and Q are the number of vertices and
+ * edges of a layer. Only the adjacency of one layer is stored and everything else is
+ * computed, so memory does not grow with the number of repetitions.
+ *
+ * If the layer is reordered, the same holds for the internal numbering of the layer,
+ * and internal_vertex(), original_vertex() and original_edge_idx() convert it from and
+ * to the numbering of LatticeFromParity built from the original layer.
+ */
+class LatticeRepeated
+{
+private:
+	LatticeFromParity layer_;
+	uint32_t repetitions_;
+	uint32_t layer_vertices_;
+	uint32_t layer_edges_;
+
+public:
+	/**
+	 * @brief Neighbors of a vertex: the neighbors within its layer followed by the
+	 * neighbors in the previous and the next layers.
+	 */
+	class Neighbors
+	{
+	private:
+		std::span<const Neighbor> layer_neighbors_;
+		uint32_t vertex_offset_;
+		uint32_t edge_offset_;
+		std::array<Neighbor, 2> timelike_{};
+		uint32_t num_timelike_ = 0;
+
+	public:
+		class Iterator
+		{
+		private:
+			const Neighbors* neighbors_ = nullptr;
+			size_t idx_ = 0;
+
+		public:
+			using iterator_concept = std::forward_iterator_tag;
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = Neighbor;
+			using difference_type = std::ptrdiff_t;
+			using pointer = void;
+			using reference = Neighbor;
+
+			Iterator() = default;
+			Iterator(const Neighbors* neighbors, size_t idx)
+				: neighbors_{neighbors}, idx_{idx}
+			{ }
+
+			auto operator*() const -> Neighbor { return (*neighbors_)[idx_]; }
+			auto operator++() -> Iterator&
+			{
+				++idx_;
+				return *this;
+			}
+			auto operator++(int) -> Iterator
+			{
+				auto res = *this;
+				++idx_;
+				return res;
+			}
+			auto operator==(const Iterator& rhs) const -> bool = default;
+		};
+
+		Neighbors(std::span<const Neighbor> layer_neighbors, uint32_t vertex_offset,
+				  uint32_t edge_offset)
+			: layer_neighbors_{layer_neighbors}, vertex_offset_{vertex_offset},
+			  edge_offset_{edge_offset}
+		{ }
+
+		void add_timelike(Neighbor neighbor) { timelike_[num_timelike_++] = neighbor; }
+
+		[[nodiscard]] auto size() const -> size_t
+		{
+			return layer_neighbors_.size() + num_timelike_;
+		}
+
+		auto operator[](size_t idx) const -> Neighbor
+		{
+			if(idx < layer_neighbors_.size())
+			{
+				const auto& neighbor = layer_neighbors_[idx];
+				return Neighbor{neighbor.vertex + vertex_offset_,
+								neighbor.edge_idx + edge_offset_};
+			}
+			return timelike_[idx - layer_neighbors_.size()];
+		}
+
+		[[nodiscard]] auto begin() const -> Iterator { return Iterator{this, 0}; }
+		[[nodiscard]] auto end() const -> Iterator { return Iterator{this, size()}; }
+	};
+
+	/**
+	 * @brief Repeat the given layer
+	 */
+	LatticeRepeated(LatticeFromParity layer, uint32_t repetitions)
+		: layer_{std::move(layer)}, repetitions_{repetitions},
+		  layer_vertices_{layer_.num_vertices()}, layer_edges_{layer_.num_edges()}
+	{
+		if(repetitions < 1)
+		{
+			throw std::invalid_argument("Repetition must be greater than or equal to 1.");
+		}
+		// vertex and edge indices of the last layer must fit in 32 bits
+		LatticeFromParity::checked_size(uint64_t{layer_vertices_} * repetitions_);
+		LatticeFromParity::checked_size(
+			(uint64_t{layer_edges_} + layer_vertices_) * repetitions_);
+	}
+
+	/**
+	 * @brief Construct a lattice from the parity matrix of a layer (CSR format). The
+	 * arguments are the same as those of the LatticeFromParity constructor with
+	 * repetitions.
+	 */
+	template<std::integral Index, std::integral IndPtr>
+	LatticeRepeated(uint32_t layer_vertex_size, uint32_t layer_num_qubits,
+					const Index* col_indices, const IndPtr* indptr, uint32_t repetitions)
+		: LatticeRepeated(
+			LatticeFromParity(layer_vertex_size, layer_num_qubits, col_indices, indptr),
+			repetitions)
+	{
+		if(repetitions < 2)
+		{
+			throw std::invalid_argument("Repetition must be greater than or equal to 2.");
+		}
+	}
+
+	[[nodiscard]] auto vertex_neighbors(uint32_t v) const -> Neighbors
+	{
+		const uint32_t depth = v / layer_vertices_;
+		const uint32_t layer_vertex = v % layer_vertices_;
+		const uint32_t stride = layer_vertices_ + layer_edges_;
+
+		Neighbors res(layer_.vertex_neighbors(layer_vertex), depth * layer_vertices_,
+					  depth * stride);
+		const uint32_t timelike_idx = layer_edges_ + layer_vertex + depth * stride;
+		if(depth > 0)
+		{
+			res.add_timelike(Neighbor{v - layer_vertices_, timelike_idx - stride});
+		}
+		if(depth + 1 < repetitions_)
+		{
+			res.add_timelike(Neighbor{v + layer_vertices_, timelike_idx});
+		}
+		return res;
+	}
+
+	[[nodiscard]] auto vertex_connections(uint32_t v) const -> std::vector<uint32_t>
+	{
+		std::vector<uint32_t> res;
+		res.reserve(vertex_connection_count(v));
+		for(const auto& neighbor : vertex_neighbors(v))
+		{
+			res.emplace_back(neighbor.vertex);
+		}
+		return res;
+	}
+
+	[[nodiscard]] auto vertex_connection_count(uint32_t v) const -> uint32_t
+	{
+		const uint32_t depth = v / layer_vertices_;
+		return layer_.vertex_connection_count(v % layer_vertices_)
+			   + static_cast<uint32_t>(depth > 0)
+			   + static_cast<uint32_t>(depth + 1 < repetitions_);
+	}
+
+	[[nodiscard]] auto edge_idx(const Edge& edge) const -> uint32_t
+	{
+		const uint32_t depth_u = edge.u / layer_vertices_;
+		const uint32_t depth_v = edge.v / layer_vertices_;
+		const uint32_t stride = layer_vertices_ + layer_edges_;
+		if(depth_u == depth_v)
+		{
+			return layer_.edge_idx({edge.u % layer_vertices_, edge.v % layer_vertices_})
+				   + depth_u * stride;
+		}
+		if(edge.v - edge.u == layer_vertices_)
+		{
+			return layer_edges_ + edge.u % layer_vertices_ + depth_u * stride;
+		}
+		throw std::out_of_range("The given edge is not in the lattice");
+	}
+
+	[[nodiscard]] auto internal_vertex(uint32_t v) const -> uint32_t
+	{
+		return v - v % layer_vertices_ + layer_.internal_vertex(v % layer_vertices_);
+	}
+
+	[[nodiscard]] auto original_vertex(uint32_t v) const -> uint32_t
+	{
+		return v - v % layer_vertices_ + layer_.original_vertex(v % layer_vertices_);
+	}
+
+	[[nodiscard]] auto original_edge_idx(uint32_t edge_idx) const -> uint32_t
+	{
+		const uint32_t stride = layer_vertices_ + layer_edges_;
+		const uint32_t idx = edge_idx % stride;
+		const uint32_t layer_idx
+			= (idx < layer_edges_)
+				  ? layer_.original_edge_idx(idx)
+				  : layer_edges_ + layer_.original_vertex(idx - layer_edges_);
+		return edge_idx - idx + layer_idx;
+	}
+
+	[[nodiscard]] auto num_vertices() const -> uint32_t
+	{
+		return layer_vertices_ * repetitions_;
+	}
+
+	[[nodiscard]] auto num_edges() const -> uint32_t
+	{
+		return layer_edges_ * repetitions_ + layer_vertices_ * (repetitions_ - 1);
+	}
+
+	/**
+	 * @brief Fold the original indices of edges in a correction onto the qubits of a
+	 * layer, in-place.
+	 *
+	 * On return, edge_indices holds the sorted indices of the spacelike edges of a layer
+	 * that are in the correction in an odd number of layers. Timelike edges, which
+	 * correct measurement errors, are dropped.
+	 */
+	void fold_layers(std::vector<uint32_t>& edge_indices) const
+	{
+		const uint32_t stride = layer_vertices_ + layer_edges_;
+		auto end = edge_indices.begin();
+		for(const auto edge_idx : edge_indices)
+		{
+			if(edge_idx % stride < layer_edges_) { *end++ = edge_idx % stride; }
+		}
+		edge_indices.erase(end, edge_indices.end());
+		std::sort(edge_indices.begin(), edge_indices.end());
+
+		// keep a qubit only if it appears an odd number of times
+		end = edge_indices.begin();
+		for(auto it = edge_indices.begin(); it != edge_indices.end();)
+		{
+			const auto next = std::find_if(it, edge_indices.end(),
+										   [it](uint32_t q) { return q != *it; });
+			if((next - it) % 2 == 1) { *end++ = *it; }
+			it = next;
+		}
+		edge_indices.erase(end, edge_indices.end());
+	}
+
+	[[nodiscard]] auto repetitions() const -> uint32_t { return repetitions_; }
+
+	[[nodiscard]] auto layer() const -> const LatticeFromParity& { return layer_; }
+
+	/**
+	 * @brief Save the layer and the number of repetitions to a binary file that can be
+	 * loaded with load()
+	 */
+	void save(const std::string& path) const { layer_.write_file(path, repetitions_); }
+
+	/**
+	 * @brief Load a lattice saved with save(). A file saved by LatticeFromParity without
+	 * repetitions is loaded as a single layer.
+	 */
+	[[nodiscard]] static auto load(const std::string& path) -> LatticeRepeated
+	{
+		auto [layer, layer_repetitions] = LatticeFromParity::read_file(path);
+		if(layer_repetitions == 0)
+		{
+			if(layer.repetitions() != 1)
+			{
+				throw std::invalid_argument(
+					path + " holds a LatticeFromParity constructed with repetitions");
+			}
+			layer_repetitions = 1;
+		}
+		return LatticeRepeated(std::move(layer), layer_repetitions);
+	}
+};
+} // namespace UnionFindCPP
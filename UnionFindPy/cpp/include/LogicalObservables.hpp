@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace UnionFindCPP
+{
+/**
+ * @brief Logical observables of a code given as a sparse matrix whose rows are
+ * observables and whose columns are edges (qubits).
+ *
+ * Observables are stored as a bitmask per edge, so the observables flipped by a
+ * correction are the XOR of the masks of its edges.
+ */
+class LogicalObservables
+{
+public:
+	/* Observables flipped by a correction fit in a single 64-bit mask */
+	constexpr static uint32_t max_observables = 64;
+
+private:
+	uint32_t num_observables_;
+	/* index: edge index. Bit k is set if the edge is in observable k */
+	std::vector<uint64_t> masks_;
+
+public:
+	/**
+	 * @brief Construct from a matrix of shape (num_observables, num_edges) in CSR format
+	 *
+	 * @param indptr edges of observable k are indices[indptr[k]] ...
+	 * indices[indptr[k+1]-1]
+	 */
+	LogicalObservables(uint32_t num_observables, uint32_t num_edges,
+					   std::span<const uint32_t> indptr,
+					   std::span<const uint32_t> indices)
+		: num_observables_{num_observables}, masks_(num_edges, 0)
+	{
+		if(num_observables > max_observables)
+		{
+			throw std::invalid_argument("At most 64 logical observables are supported");
+		}
+		if(indptr.size() != size_t{num_observables} + 1 || indptr.front() != 0
+		   || indptr.back() != indices.size())
+		{
+			throw std::invalid_argument("indptr of logical observables is invalid");
+		}
+
+		for(uint32_t k = 0; k < num_observables; ++k)
+		{
+			if(indptr[k] > indptr[k + 1])
+			{
+				throw std::invalid_argument("indptr of logical observables is invalid");
+			}
+			for(auto idx = indptr[k]; idx < indptr[k + 1]; ++idx)
+			{
+				if(indices[idx] >= num_edges)
+				{
+					throw std::invalid_argument(
+						"Indices of logical observables must be smaller than "
+						"the number of edges");
+				}
+				masks_[indices[idx]] ^= uint64_t{1} << k;
+			}
+		}
+	}
+
+	[[nodiscard]] auto num_observables() const -> uint32_t { return num_observables_; }
+
+	[[nodiscard]] auto num_edges() const -> uint32_t
+	{
+		return static_cast<uint32_t>(masks_.size());
+	}
+
+	/**
+	 * @brief Observables containing the edge as a bitmask
+	 */
+	[[nodiscard]] auto mask(uint32_t edge_idx) const -> uint64_t
+	{
+		return masks_[edge_idx];
+	}
+};
+} // namespace UnionFindCPP
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace UnionFindCPP
+{
+/**
+ * @brief Read-only contents of a file. The memory is released when the last copy of
+ * data is destroyed.
+ */
+struct MappedFile
+{
+	std::shared_ptr<const std::byte> data;
+	size_t size = 0;
+};
+
+#if !defined(_WIN32)
+namespace detail
+{
+	struct Unmap
+	{
+		size_t size;
+
+		void operator()(const std::byte* ptr) const
+		{
+			// NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+			::munmap(const_cast<std::byte*>(ptr), size);
+		}
+	};
+} // namespace detail
+#endif
+
+/**
+ * @brief Map a file read-only into memory.
+ *
+ * On POSIX systems the file is mmap-ed, so processes mapping the same file share the
+ * physical pages and nothing is read until it is used. Elsewhere the file is read into
+ * a heap buffer aligned to 8 bytes.
+ */
+inline auto map_file(const std::string& path) -> MappedFile
+{
+#if !defined(_WIN32)
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if(fd < 0) { throw std::runtime_error("Cannot open file " + path); }
+
+	struct stat st
+	{
+	};
+	if(::fstat(fd, &st) != 0)
+	{
+		::close(fd);
+		throw std::runtime_error("Cannot read the size of file " + path);
+	}
+	const auto size = static_cast<size_t>(st.st_size);
+	if(size == 0)
+	{
+		::close(fd);
+		return MappedFile{std::make_shared<const std::byte>(), 0};
+	}
+
+	void* addr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd); // the mapping stays valid after closing the descriptor
+	if(addr == MAP_FAILED) { throw std::runtime_error("Cannot map file " + path); }
+
+	auto data = std::shared_ptr<const std::byte>(static_cast<const std::byte*>(addr),
+												 detail::Unmap{size});
+	return MappedFile{std::move(data), size};
+#else
+	std::ifstream fin(path, std::ios::binary | std::ios::ate);
+	if(!fin) { throw std::runtime_error("Cannot open file " + path); }
+	const auto size = static_cast<size_t>(fin.tellg());
+	fin.seekg(0);
+
+	auto buffer = std::make_shared<std::vector<uint64_t>>((size + 7) / 8);
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+	fin.read(reinterpret_cast<char*>(buffer->data()), static_cast<std::streamsize>(size));
+	if(!fin) { throw std::runtime_error("Cannot read file " + path); }
+
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+	const auto* ptr = reinterpret_cast<const std::byte*>(buffer->data());
+	return MappedFile{std::shared_ptr<const std::byte>(std::move(buffer), ptr), size};
+#endif
+}
+} // namespace UnionFindCPP
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace UnionFindCPP
+{
+/**
+ * @brief Split [0, n) into num_threads contiguous ranges and call func(begin, end) for
+ * each of them on its own thread. The calling thread processes the first range.
+ *
+ * All threads are joined before returning. If func throws, the first exception is
+ * rethrown afterwards; other ranges may have been processed partially.
+ */
+template<typename Index, typename Func>
+void parallel_for(size_t num_threads, Index n, const Func& func)
+{
+	num_threads = std::clamp<size_t>(num_threads, 1, std::max<size_t>(n, 1));
+	const auto range_begin = [&](size_t thread_idx)
+	{ return static_cast<Index>(n * thread_idx / num_threads); };
+
+	std::mutex mutex;
+	std::exception_ptr error;
+	const auto run = [&](Index begin, Index end)
+	{
+		try
+		{
+			func(begin, end);
+		}
+		catch(...)
+		{
+			const std::lock_guard<std::mutex> lock(mutex);
+			if(!error) { error = std::current_exception(); }
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(num_threads - 1);
+	try
+	{
+		for(size_t thread_idx = 1; thread_idx < num_threads; ++thread_idx)
+		{
+			threads.emplace_back(run, range_begin(thread_idx),
+								 range_begin(thread_idx + 1));
+		}
+	}
+	catch(...)
+	{
+		// a joinable std::thread calls std::terminate when destroyed
+		for(auto& thread : threads) { thread.join(); }
+		throw;
+	}
+	run(Index{0}, range_begin(1));
+	for(auto& thread : threads) { thread.join(); }
+
+	if(error) { std::rethrow_exception(error); }
+}
+} // namespace UnionFindCPP
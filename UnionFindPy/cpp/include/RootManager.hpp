@@ -55,8 +55,13 @@ public:
 
 	friend class SizeProxy;
 
+	RootManager() = default;
+	/* Hash containers grow on demand, so the number of vertices is not used. */
+	explicit RootManager(uint32_t /*num_vertices*/) { }
+
 	void initialize_roots(const std::vector<Vertex>& roots)
 	{
+		clear();
 		const auto n_reserve = 2 * roots.size();
 		roots_.reserve(n_reserve);
 		odd_roots_.reserve(n_reserve);
@@ -128,12 +133,13 @@ public:
 
 	[[nodiscard]] auto isempty_odd_root() const -> bool { return odd_roots_.empty(); }
 
+	/* Buckets of the hash containers are kept for the next initialization. */
 	void clear()
 	{
-		tsl::robin_set<Vertex>().swap(roots_);
-		tsl::robin_set<Vertex>().swap(odd_roots_);
-		tsl::robin_map<Vertex, uint32_t>().swap(size_);
-		tsl::robin_map<Vertex, uint32_t>().swap(parity_);
+		roots_.clear();
+		odd_roots_.clear();
+		size_.clear();
+		parity_.clear();
 	}
 
 	[[nodiscard]] auto odd_roots() const& -> const tsl::robin_set<Vertex>&
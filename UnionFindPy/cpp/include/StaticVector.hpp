@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+namespace UnionFindCPP
+{
+/**
+ * @brief A vector with a fixed capacity whose elements live inside the object.
+ *
+ * Used as the return type of vertex_connections for lattices whose vertices have
+ * different numbers of neighbors, so that no heap allocation is needed.
+ *
+ * @tparam T trivially copyable element type
+ * @tparam N maximum number of elements
+ */
+template<typename T, std::size_t N> class StaticVector
+{
+private:
+	std::array<T, N> data_{};
+	uint32_t size_ = 0;
+
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+	using iterator = typename std::array<T, N>::iterator;
+	using const_iterator = typename std::array<T, N>::const_iterator;
+
+	constexpr StaticVector() = default;
+
+	constexpr StaticVector(std::initializer_list<T> init)
+	{
+		assert(init.size() <= N);
+		for(const auto& elt : init) { data_[size_++] = elt; }
+	}
+
+	constexpr void push_back(const T& elt)
+	{
+		assert(size_ < N);
+		data_[size_++] = elt;
+	}
+
+	constexpr auto emplace_back(const T& elt) -> T&
+	{
+		push_back(elt);
+		return data_[size_ - 1];
+	}
+
+	[[nodiscard]] constexpr auto size() const -> size_type { return size_; }
+	[[nodiscard]] constexpr static auto capacity() -> size_type { return N; }
+	[[nodiscard]] constexpr auto empty() const -> bool { return size_ == 0; }
+
+	constexpr auto operator[](size_type idx) -> T& { return data_[idx]; }
+	constexpr auto operator[](size_type idx) const -> const T& { return data_[idx]; }
+
+	[[nodiscard]] constexpr auto data() -> T* { return data_.data(); }
+	[[nodiscard]] constexpr auto data() const -> const T* { return data_.data(); }
+
+	constexpr auto begin() -> iterator { return data_.begin(); }
+	constexpr auto end() -> iterator { return data_.begin() + size_; }
+	constexpr auto begin() const -> const_iterator { return data_.begin(); }
+	constexpr auto end() const -> const_iterator { return data_.begin() + size_; }
+};
+} // namespace UnionFindCPP
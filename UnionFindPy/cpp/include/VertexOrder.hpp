@@ -0,0 +1,95 @@
+#pragma once
+#include "utility.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <vector>
+
+namespace UnionFindCPP
+{
+/**
+ * @brief Numbering of the vertices of a lattice used inside the decoder.
+ *
+ * Vertices adjacent in the graph get nearby numbers with BreadthFirst and
+ * ReverseCuthillMcKee, so the arrays indexed by vertex are accessed locally while
+ * clusters grow.
+ */
+enum class VertexOrder
+{
+	/* Keep the order of the rows of the parity matrix */
+	Original,
+	/* Breadth-first search from the smallest unvisited vertex of each component */
+	BreadthFirst,
+	/* Reverse Cuthill-McKee, which minimizes the bandwidth of the adjacency matrix */
+	ReverseCuthillMcKee
+};
+
+/**
+ * @brief Compute a new numbering of the vertices of a graph in CSR format.
+ *
+ * @param offsets neighbors of vertex v are neighbors[offsets[v]] ...
+ * neighbors[offsets[v+1]-1]
+ * @return the current index of each vertex in the new order
+ */
+template<std::unsigned_integral Index>
+auto compute_vertex_order(std::span<const Index> offsets,
+						  std::span<const BasicNeighbor<Index>> neighbors,
+						  VertexOrder order)
+	-> std::vector<Index>
+{
+	const auto num_vertices = static_cast<Index>(offsets.size() - 1);
+	std::vector<Index> res(num_vertices);
+	std::iota(res.begin(), res.end(), Index{0});
+	if(order == VertexOrder::Original) { return res; }
+
+	const auto degree = [offsets](Index v) { return offsets[v + 1] - offsets[v]; };
+	const bool by_degree = (order == VertexOrder::ReverseCuthillMcKee);
+
+	/* Each component is searched from its first vertex in this list. Cuthill-McKee
+	 * starts from a vertex of minimum degree, which is close to the periphery */
+	std::vector<Index> starts = res;
+	if(by_degree)
+	{
+		std::stable_sort(starts.begin(), starts.end(), [&](Index lhs, Index rhs)
+						 { return degree(lhs) < degree(rhs); });
+	}
+
+	/* res is filled in the order of visits and is also the queue of the search */
+	std::vector<uint8_t> visited(num_vertices, 0);
+	Index num_visited = 0;
+	Index head = 0;
+	std::vector<Index> unvisited_neighbors;
+	for(const auto start : starts)
+	{
+		if(visited[start] != 0) { continue; }
+		visited[start] = 1;
+		res[num_visited++] = start;
+
+		while(head < num_visited)
+		{
+			const Index v = res[head++];
+			unvisited_neighbors.clear();
+			for(auto idx = offsets[v]; idx < offsets[v + 1]; ++idx)
+			{
+				const Index u = neighbors[idx].vertex;
+				if(visited[u] != 0) { continue; }
+				visited[u] = 1;
+				unvisited_neighbors.emplace_back(u);
+			}
+			if(by_degree)
+			{
+				std::stable_sort(unvisited_neighbors.begin(), unvisited_neighbors.end(),
+								 [&](Index lhs, Index rhs)
+								 { return degree(lhs) < degree(rhs); });
+			}
+			for(const auto u : unvisited_neighbors) { res[num_visited++] = u; }
+		}
+	}
+
+	if(by_degree) { std::reverse(res.begin(), res.end()); }
+	return res;
+}
+} // namespace UnionFindCPP
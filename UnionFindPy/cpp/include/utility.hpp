@@ -1,6 +1,7 @@
 #pragma once
 #include <algorithm>
 #include <climits>
+#include <concepts>
 #include <cstdint>
 #include <functional>
 #include <ostream>
@@ -26,11 +27,7 @@ struct Edge
 	uint32_t u;
 	uint32_t v;
 
-	Edge(uint32_t ul, uint32_t vl)
-	{
-		u = std::min(ul, vl);
-		v = std::max(ul, vl);
-	}
+	constexpr Edge(uint32_t ul, uint32_t vl) : u{std::min(ul, vl)}, v{std::max(ul, vl)} { }
 
 	inline auto operator==(const Edge& rhs) const -> bool
 	{
@@ -38,6 +35,19 @@ struct Edge
 	}
 };
 
+/**
+ * @brief A neighboring vertex together with the index of the edge connecting to it
+ *
+ * @tparam Index unsigned integer type of vertices and edge indices
+ */
+template<std::unsigned_integral Index> struct BasicNeighbor
+{
+	Index vertex;
+	Index edge_idx;
+};
+
+using Neighbor = BasicNeighbor<uint32_t>;
+
 void to_json(nlohmann::json& j, const Edge& e);
 void from_json(const nlohmann::json& j, Edge& e);
 auto operator<<(std::ostream& os, const UnionFindCPP::Edge& e) -> std::ostream&;
@@ -0,0 +1,667 @@
+// Copyright (C) 2021 UnionFind++ authors
+//
+// This file is part of UnionFind++.
+//
+// UnionFind++ is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UnionFind++ is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UnionFind++.  If not, see <https://www.gnu.org/licenses/>.
+#include "../examples/Lattice2D.hpp"
+#include "../examples/Lattice2DStatic.hpp"
+#include "../examples/LatticeCubic.hpp"
+#include "../examples/LatticeCubicStatic.hpp"
+#include "BatchDecoder.hpp"
+#include "Decoder.hpp"
+#include "DecoderState.hpp"
+#include "DenseRootManager.hpp"
+#include "FindRootPolicy.hpp"
+#include "HugePageAllocator.hpp"
+#include "LatticeFromParity.hpp"
+#include "LogicalObservables.hpp"
+#include "RootManager.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+using UnionFindCPP::Edge;
+
+/**
+ * @brief flip each edge of the lattice with probability p and return the syndromes
+ */
+template<class Lattice, class RandomEngine>
+auto random_syndromes(const Lattice& lattice, double p, RandomEngine& re)
+	-> std::vector<uint32_t>
+{
+	std::bernoulli_distribution flip(p);
+	std::vector<uint32_t> syndromes(lattice.num_vertices(), 0U);
+	for(uint32_t edge_idx = 0; edge_idx < lattice.num_edges(); ++edge_idx)
+	{
+		if(!flip(re)) { continue; }
+		const Edge e = lattice.to_edge(edge_idx);
+		syndromes[e.u] ^= 1U;
+		syndromes[e.v] ^= 1U;
+	}
+	return syndromes;
+}
+
+/**
+ * @brief check that applying corrections to the syndromes removes all defects
+ */
+auto corrections_cancel_syndromes(std::vector<uint32_t> syndromes,
+								  const std::vector<Edge>& corrections) -> bool
+{
+	for(const auto& e : corrections)
+	{
+		syndromes[e.u] ^= 1U;
+		syndromes[e.v] ^= 1U;
+	}
+	return std::all_of(syndromes.begin(), syndromes.end(),
+					   [](uint32_t s) { return s == 0; });
+}
+
+TEMPLATE_TEST_CASE("Decoder removes all defects", "[Decoder]", RootManager,
+				   UnionFindCPP::DenseRootManager)
+{
+	using UnionFindCPP::Decoder, UnionFindCPP::Lattice2D, UnionFindCPP::LatticeCubic;
+
+	std::mt19937 re{1337U}; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+
+	SECTION("Lattice2D")
+	{
+		for(const uint32_t L : {5U, 8U, 13U})
+		{
+			const Lattice2D lattice(L);
+			Decoder<Lattice2D, TestType> decoder(L);
+			for(const double p : {0.01, 0.05, 0.1})
+			{
+				for(int iter = 0; iter < 20; ++iter)
+				{
+					auto syndromes = random_syndromes(lattice, p, re);
+					auto syndromes_copy = syndromes;
+					decoder.clear();
+					auto corrections = decoder.decode(syndromes_copy);
+					REQUIRE(corrections_cancel_syndromes(syndromes, corrections));
+				}
+			}
+		}
+	}
+
+	SECTION("LatticeCubic")
+	{
+		for(const uint32_t L : {3U, 6U, 9U})
+		{
+			const LatticeCubic lattice(L);
+			Decoder<LatticeCubic, TestType> decoder(L);
+			for(const double p : {0.01, 0.03})
+			{
+				for(int iter = 0; iter < 20; ++iter)
+				{
+					auto syndromes = random_syndromes(lattice, p, re);
+					auto syndromes_copy = syndromes;
+					decoder.clear();
+					auto corrections = decoder.decode(syndromes_copy);
+					REQUIRE(corrections_cancel_syndromes(syndromes, corrections));
+				}
+			}
+		}
+	}
+}
+
+TEMPLATE_TEST_CASE("Decoder with different find_root policies", "[Decoder]",
+				   UnionFindCPP::PathCompression, UnionFindCPP::PathHalving,
+				   UnionFindCPP::PathSplitting)
+{
+	using UnionFindCPP::Decoder, UnionFindCPP::DenseRootManager,
+		UnionFindCPP::LatticeCubic;
+
+	std::mt19937 re{1337U}; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+
+	for(const uint32_t L : {4U, 9U})
+	{
+		const LatticeCubic lattice(L);
+		Decoder<LatticeCubic, DenseRootManager, TestType> decoder(L);
+		for(const double p : {0.01, 0.05})
+		{
+			for(int iter = 0; iter < 20; ++iter)
+			{
+				auto syndromes = random_syndromes(lattice, p, re);
+				auto syndromes_copy = syndromes;
+				decoder.clear();
+				auto corrections = decoder.decode(syndromes_copy);
+				REQUIRE(corrections_cancel_syndromes(syndromes, corrections));
+			}
+		}
+	}
+}
+
+TEST_CASE("CompactState gives the same corrections as WideState", "[Decoder]")
+{
+	using UnionFindCPP::CompactState, UnionFindCPP::Decoder,
+		UnionFindCPP::DenseRootManager, UnionFindCPP::Lattice2D,
+		UnionFindCPP::LatticeCubic, UnionFindCPP::PathHalving;
+
+	std::mt19937 re{1337U}; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+
+	SECTION("Lattice2D")
+	{
+		const uint32_t L = 15;
+		const Lattice2D lattice(L);
+		Decoder<Lattice2D> wide(L);
+		Decoder<Lattice2D, DenseRootManager, PathHalving, CompactState> compact(L);
+		for(int iter = 0; iter < 50; ++iter)
+		{
+			const auto syndromes = random_syndromes(lattice, 0.05, re);
+			wide.clear();
+			compact.clear();
+			REQUIRE(wide.decode(syndromes) == compact.decode(syndromes));
+		}
+	}
+
+	SECTION("LatticeCubic")
+	{
+		const uint32_t L = 9;
+		const LatticeCubic lattice(L);
+		Decoder<LatticeCubic> wide(L);
+		Decoder<LatticeCubic, DenseRootManager, PathHalving, CompactState> compact(L);
+		for(int iter = 0; iter < 50; ++iter)
+		{
+			const auto syndromes = random_syndromes(lattice, 0.03, re);
+			wide.clear();
+			compact.clear();
+			REQUIRE(wide.decode(syndromes) == compact.decode(syndromes));
+		}
+	}
+
+	SECTION("Vertex with too many neighbors")
+	{
+		// parity 0 shares a qubit with each of the other parities
+		const uint32_t num_qubits = 300;
+		std::vector<uint32_t> col_indices;
+		std::vector<uint32_t> indptr{0};
+		for(uint32_t q = 0; q < num_qubits; ++q) { col_indices.push_back(q); }
+		indptr.push_back(num_qubits);
+		for(uint32_t q = 0; q < num_qubits; ++q)
+		{
+			col_indices.push_back(q);
+			indptr.push_back(num_qubits + q + 1);
+		}
+		const UnionFindCPP::LatticeFromParity lattice(num_qubits + 1, num_qubits,
+													  col_indices.data(), indptr.data());
+		REQUIRE_THROWS_AS(CompactState(lattice), std::invalid_argument);
+	}
+}
+
+TEST_CASE("Decoder with smallest-first growth removes all defects", "[Decoder]")
+{
+	using UnionFindCPP::Decoder, UnionFindCPP::GrowthPolicy, UnionFindCPP::Lattice2D,
+		UnionFindCPP::LatticeCubic;
+
+	std::mt19937 re{1337U}; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+
+	SECTION("Lattice2D")
+	{
+		const uint32_t L = 10;
+		const Lattice2D lattice(L);
+		Decoder<Lattice2D> decoder(L);
+		decoder.set_growth_policy(GrowthPolicy::SmallestFirst);
+		for(const double p : {0.01, 0.05, 0.1})
+		{
+			for(int iter = 0; iter < 20; ++iter)
+			{
+				const auto syndromes = random_syndromes(lattice, p, re);
+				decoder.clear();
+				const auto corrections = decoder.decode(syndromes);
+				REQUIRE(corrections_cancel_syndromes(syndromes, corrections));
+			}
+		}
+	}
+
+	SECTION("LatticeCubic")
+	{
+		const uint32_t L = 7;
+		const LatticeCubic lattice(L);
+		Decoder<LatticeCubic, RootManager> decoder(L);
+		decoder.set_growth_policy(GrowthPolicy::SmallestFirst);
+		for(const double p : {0.01, 0.03})
+		{
+			for(int iter = 0; iter < 20; ++iter)
+			{
+				const auto syndromes = random_syndromes(lattice, p, re);
+				decoder.clear();
+				const auto corrections = decoder.decode(syndromes);
+				REQUIRE(corrections_cancel_syndromes(syndromes, corrections));
+			}
+		}
+	}
+}
+
+/**
+ * @brief check that two lattices have the same vertices and edges in the same order
+ */
+template<class Lattice1, class Lattice2>
+void check_same_indices(const Lattice1& lattice1, const Lattice2& lattice2)
+{
+	REQUIRE(lattice1.num_vertices() == lattice2.num_vertices());
+	REQUIRE(lattice1.num_edges() == lattice2.num_edges());
+	for(uint32_t v = 0; v < lattice1.num_vertices(); ++v)
+	{
+		const auto connections1 = lattice1.vertex_connections(v);
+		const auto connections2 = lattice2.vertex_connections(v);
+		REQUIRE(lattice1.vertex_connection_count(v) == lattice2.vertex_connection_count(v));
+		REQUIRE(std::equal(connections1.begin(), connections1.end(), connections2.begin(),
+						   connections2.end()));
+		for(const auto& neighbor : lattice2.vertex_neighbors(v))
+		{
+			REQUIRE(lattice1.edge_idx({v, neighbor.vertex}) == neighbor.edge_idx);
+		}
+	}
+	for(uint32_t edge_idx = 0; edge_idx < lattice1.num_edges(); ++edge_idx)
+	{
+		REQUIRE(lattice1.to_edge(edge_idx) == lattice2.to_edge(edge_idx));
+	}
+}
+
+TEST_CASE("Lattices with L fixed at compile time", "[Decoder]")
+{
+	using UnionFindCPP::Decoder, UnionFindCPP::Lattice2D, UnionFindCPP::Lattice2DStatic,
+		UnionFindCPP::LatticeCubic, UnionFindCPP::LatticeCubicStatic;
+
+	std::mt19937 re{1337U}; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+
+	SECTION("Lattice2DStatic")
+	{
+		check_same_indices(Lattice2D(5), Lattice2DStatic<5>{});
+		check_same_indices(Lattice2D(8), Lattice2DStatic<8>{});
+		REQUIRE_THROWS_AS(Lattice2DStatic<5>(7), std::invalid_argument);
+	}
+
+	SECTION("LatticeCubicStatic")
+	{
+		check_same_indices(LatticeCubic(5), LatticeCubicStatic<5>{});
+		check_same_indices(LatticeCubic(8), LatticeCubicStatic<8>{});
+		REQUIRE_THROWS_AS(LatticeCubicStatic<5>(7), std::invalid_argument);
+	}
+
+	SECTION("Same corrections as the runtime lattice")
+	{
+		const uint32_t L = 7;
+		const LatticeCubic lattice(L);
+		Decoder<LatticeCubic> decoder(L);
+		Decoder<LatticeCubicStatic<L>> static_decoder(L);
+		for(int iter = 0; iter < 20; ++iter)
+		{
+			const auto syndromes = random_syndromes(lattice, 0.03, re);
+			decoder.clear();
+			static_decoder.clear();
+			REQUIRE(decoder.decode(syndromes) == static_decoder.decode(syndromes));
+		}
+	}
+}
+
+TEMPLATE_TEST_CASE("Reused decoder gives the same result as a fresh one", "[Decoder]",
+				   RootManager, UnionFindCPP::DenseRootManager)
+{
+	using UnionFindCPP::Decoder, UnionFindCPP::LatticeCubic;
+
+	std::mt19937 re{42U}; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	const uint32_t L = 7;
+	const LatticeCubic lattice(L);
+	Decoder<LatticeCubic, TestType> reused(L);
+	Decoder<LatticeCubic, TestType> cleared(L);
+	Decoder<LatticeCubic, TestType> released(L);
+	released.set_scratch_capacity(0); // clear() frees all scratch buffers
+
+	for(int iter = 0; iter < 50; ++iter)
+	{
+		const auto syndromes = random_syndromes(lattice, 0.02, re);
+
+		Decoder<LatticeCubic, TestType> fresh(L);
+		const auto expected = fresh.decode(syndromes);
+
+		REQUIRE(reused.decode(syndromes) == expected);
+
+		cleared.clear();
+		REQUIRE(cleared.decode(syndromes) == expected);
+
+		released.clear();
+		REQUIRE(released.decode(syndromes) == expected);
+	}
+}
+
+TEMPLATE_TEST_CASE("decode_defects gives the same corrections as decode", "[Decoder]",
+				   UnionFindCPP::Lattice2D, UnionFindCPP::LatticeCubic)
+{
+	using UnionFindCPP::Decoder;
+
+	std::mt19937 re{2024U}; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	const uint32_t L = 9;
+	const TestType lattice(L);
+	Decoder<TestType> decoder(L);
+
+	for(int iter = 0; iter < 50; ++iter)
+	{
+		const auto syndromes = random_syndromes(lattice, 0.02, re);
+		std::vector<uint32_t> defects;
+		for(uint32_t v = 0; v < syndromes.size(); ++v)
+		{
+			if(syndromes[v] != 0) { defects.push_back(v); }
+		}
+
+		decoder.clear();
+		std::vector<uint32_t> expected;
+		for(const auto& edge : decoder.decode(syndromes))
+		{
+			expected.push_back(decoder.edge_idx(edge));
+		}
+		decoder.clear();
+		REQUIRE(decoder.decode_defects(defects) == expected);
+	}
+}
+
+TEST_CASE("Peeling a spanning forest gives the unique correction", "[Decoder]")
+{
+	using UnionFindCPP::Decoder, UnionFindCPP::GrowthPolicy,
+		UnionFindCPP::LatticeFromParity;
+
+	/*
+	 * A forest of two trees, with edge indices in brackets:
+	 *   0 -[0]- 1 -[1]- 2 -[2]- 3 -[3]- 4 -[4]- 5        7 -[6]- 8 -[7]- 9
+	 *           |
+	 *          [5]
+	 *           |
+	 *           6
+	 * Defects at 0 and 5 grow into a cluster spanning the chain 0-5 and the branch 1-6,
+	 * whose edge must be peeled away. On a forest, the correction is the unique set of
+	 * edges whose boundary is the defects.
+	 */
+	const std::vector<uint32_t> col_indices{0, 0, 1, 5, 1, 2, 2, 3,
+											3, 4, 4, 5, 6, 6, 7, 7};
+	const std::vector<uint32_t> indptr{0, 1, 4, 6, 8, 10, 11, 12, 13, 15, 16};
+	const auto lattice = std::make_shared<const LatticeFromParity>(
+		10, 8, col_indices.data(), indptr.data());
+
+	const auto sorted_corrections
+		= [](auto& decoder, const std::vector<uint32_t>& defects)
+	{
+		decoder.clear();
+		auto corrections = decoder.decode_defects(defects);
+		std::sort(corrections.begin(), corrections.end());
+		return corrections;
+	};
+
+	for(const auto policy : {GrowthPolicy::AllOddClusters, GrowthPolicy::SmallestFirst})
+	{
+		Decoder<LatticeFromParity> decoder(lattice);
+		decoder.set_growth_policy(policy);
+
+		REQUIRE(sorted_corrections(decoder, {0, 5})
+				== std::vector<uint32_t>{0, 1, 2, 3, 4});
+		REQUIRE(sorted_corrections(decoder, {0, 6}) == std::vector<uint32_t>{0, 5});
+		REQUIRE(sorted_corrections(decoder, {5, 6})
+				== std::vector<uint32_t>{1, 2, 3, 4, 5});
+		REQUIRE(sorted_corrections(decoder, {0, 2, 5, 6})
+				== std::vector<uint32_t>{0, 2, 3, 4, 5});
+		REQUIRE(sorted_corrections(decoder, {0, 5, 7, 9})
+				== std::vector<uint32_t>{0, 1, 2, 3, 4, 6, 7});
+		REQUIRE(sorted_corrections(decoder, {3, 6, 7, 8})
+				== std::vector<uint32_t>{1, 2, 5, 6});
+	}
+}
+
+TEST_CASE("Decoding into caller-provided buffers", "[Decoder]")
+{
+	using UnionFindCPP::Decoder, UnionFindCPP::LatticeCubic;
+
+	std::mt19937 re{515U}; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	const uint32_t L = 7;
+	const LatticeCubic lattice(L);
+	Decoder<LatticeCubic> decoder(L);
+	Decoder<LatticeCubic> fresh_decoder(L);
+
+	std::vector<uint32_t> corrections;
+	corrections.reserve(lattice.num_edges());
+	const auto* const buffer = corrections.data();
+	std::vector<uint8_t> bitmap(lattice.num_edges());
+
+	for(int iter = 0; iter < 50; ++iter)
+	{
+		const auto syndromes = random_syndromes(lattice, 0.03, re);
+		const auto syndromes_span = std::span<const uint32_t>(syndromes);
+
+		std::vector<uint32_t> expected;
+		fresh_decoder.clear();
+		for(const auto& edge : fresh_decoder.decode(syndromes))
+		{
+			expected.push_back(static_cast<uint32_t>(fresh_decoder.edge_idx(edge)));
+		}
+
+		decoder.decode(syndromes_span, corrections);
+		REQUIRE(corrections == expected);
+		REQUIRE(corrections.data() == buffer);
+
+		std::fill(bitmap.begin(), bitmap.end(), uint8_t{1});
+		decoder.decode(syndromes_span, std::span<uint8_t>(bitmap));
+		std::vector<uint8_t> expected_bitmap(lattice.num_edges(), 0);
+		for(const auto idx : expected) { expected_bitmap[idx] = 1; }
+		REQUIRE(bitmap == expected_bitmap);
+	}
+}
+
+TEST_CASE("Decoder with huge pages gives the same result", "[Decoder]")
+{
+	using UnionFindCPP::Decoder, UnionFindCPP::LatticeCubic;
+
+	std::mt19937 re{2048U}; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	const uint32_t L = 64; // support of edges spans more than a huge page
+	const LatticeCubic lattice(L);
+	Decoder<LatticeCubic> decoder(L);
+	UnionFindCPP::set_huge_pages_enabled(true);
+	Decoder<LatticeCubic> huge_page_decoder(L);
+
+	const auto address = [](const auto& arr)
+	{
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		return reinterpret_cast<uintptr_t>(arr.data());
+	};
+	const UnionFindCPP::LargeVector<uint8_t> small(3);
+	REQUIRE(address(small) % UnionFindCPP::cache_line_size == 0);
+	const UnionFindCPP::LargeVector<uint32_t> large(lattice.num_edges());
+#if defined(__linux__)
+	REQUIRE(address(large) % UnionFindCPP::huge_page_size == 0);
+#endif
+	UnionFindCPP::set_huge_pages_enabled(false);
+
+	// arrays keep the allocation of the setting they were constructed with
+	const UnionFindCPP::LargeVector<uint32_t> normal(lattice.num_edges());
+	REQUIRE(!normal.get_allocator().uses_huge_pages());
+	REQUIRE(large.get_allocator().uses_huge_pages());
+	auto moved = large;
+	REQUIRE(moved.get_allocator().uses_huge_pages());
+	moved = normal;
+	moved = UnionFindCPP::LargeVector<uint32_t>(small.size());
+	REQUIRE(!moved.get_allocator().uses_huge_pages());
+
+	for(int iter = 0; iter < 5; ++iter)
+	{
+		const auto syndromes = random_syndromes(lattice, 0.01, re);
+		REQUIRE(huge_page_decoder.decode(syndromes) == decoder.decode(syndromes));
+	}
+}
+
+TEST_CASE("decode_observables gives the observables flipped by decode", "[Decoder]")
+{
+	using UnionFindCPP::BatchDecoder, UnionFindCPP::Decoder, UnionFindCPP::Lattice2D,
+		UnionFindCPP::LogicalObservables;
+
+	std::mt19937 re{64U}; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	const uint32_t L = 9;
+	const uint32_t num_observables = 5;
+	const uint32_t num_shots = 30;
+	const Lattice2D lattice(L);
+
+	// random observables in CSR format
+	std::bernoulli_distribution in_observable(0.3);
+	std::vector<uint32_t> indptr{0};
+	std::vector<uint32_t> indices;
+	for(uint32_t k = 0; k < num_observables; ++k)
+	{
+		for(uint32_t e = 0; e < lattice.num_edges(); ++e)
+		{
+			if(in_observable(re)) { indices.push_back(e); }
+		}
+		indptr.push_back(static_cast<uint32_t>(indices.size()));
+	}
+	const auto observables = std::make_shared<const LogicalObservables>(
+		num_observables, lattice.num_edges(), indptr, indices);
+
+	Decoder<Lattice2D> decoder(L);
+	REQUIRE_THROWS_AS(decoder.decode_observables(std::span<const uint32_t>(
+						  std::vector<uint32_t>(lattice.num_vertices()))),
+					  std::logic_error);
+	decoder.set_observables(observables);
+
+	std::vector<uint32_t> syndromes;
+	std::vector<uint64_t> expected;
+	for(uint32_t shot = 0; shot < num_shots; ++shot)
+	{
+		const auto shot_syndromes = random_syndromes(lattice, 0.05, re);
+		syndromes.insert(syndromes.end(), shot_syndromes.begin(), shot_syndromes.end());
+
+		uint64_t flipped = 0;
+		for(const auto& edge : decoder.decode(shot_syndromes))
+		{
+			flipped ^= observables->mask(static_cast<uint32_t>(decoder.edge_idx(edge)));
+		}
+		REQUIRE(decoder.decode_observables(std::span<const uint32_t>(shot_syndromes))
+				== flipped);
+		expected.push_back(flipped);
+	}
+
+	BatchDecoder<Lattice2D> batch_decoder(3, decoder.lattice_ptr());
+	batch_decoder.set_observables(decoder.observables_ptr());
+	std::vector<uint64_t> flipped(num_shots);
+	batch_decoder.decode_batch_observables(std::span<const uint32_t>(syndromes),
+										   std::span<uint64_t>(flipped));
+	REQUIRE(flipped == expected);
+
+	REQUIRE_THROWS_AS(LogicalObservables(65, lattice.num_edges(),
+										 std::vector<uint32_t>(66, 0), {}),
+					  std::invalid_argument);
+	REQUIRE_THROWS_AS(LogicalObservables(1, lattice.num_edges(),
+										 std::vector<uint32_t>{0, 1},
+										 std::vector<uint32_t>{lattice.num_edges()}),
+					  std::invalid_argument);
+}
+
+TEST_CASE("Decoders can share a lattice", "[Decoder]")
+{
+	using UnionFindCPP::Decoder, UnionFindCPP::LatticeCubic;
+
+	std::mt19937 re{7U}; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	const uint32_t L = 5;
+	auto lattice = std::make_shared<const LatticeCubic>(L);
+
+	Decoder<LatticeCubic> decoder1(lattice);
+	Decoder<LatticeCubic> decoder2(decoder1.lattice_ptr());
+	REQUIRE(&decoder1.lattice() == lattice.get());
+	REQUIRE(&decoder2.lattice() == lattice.get());
+
+	for(int iter = 0; iter < 20; ++iter)
+	{
+		auto syndromes = random_syndromes(*lattice, 0.03, re);
+		auto syndromes1 = syndromes;
+		auto syndromes2 = syndromes;
+		decoder1.clear();
+		decoder2.clear();
+		REQUIRE(decoder1.decode(syndromes1) == decoder2.decode(syndromes2));
+	}
+}
+
+TEST_CASE("BatchDecoder gives the same result as Decoder", "[BatchDecoder]")
+{
+	using UnionFindCPP::BatchDecoder, UnionFindCPP::Decoder, UnionFindCPP::LatticeCubic;
+
+	std::mt19937 re{42U}; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	const uint32_t L = 6;
+	const uint32_t num_shots = 40;
+	const LatticeCubic lattice(L);
+
+	std::vector<uint8_t> syndromes;
+	for(uint32_t shot = 0; shot < num_shots; ++shot)
+	{
+		const auto shot_syndromes = random_syndromes(lattice, 0.03, re);
+		syndromes.insert(syndromes.end(), shot_syndromes.begin(), shot_syndromes.end());
+	}
+
+	for(const size_t num_threads : {1U, 3U})
+	{
+		BatchDecoder<LatticeCubic> batch_decoder(num_threads, L);
+		REQUIRE(batch_decoder.num_threads() == num_threads);
+
+		std::vector<uint32_t> corrections(size_t{num_shots} * lattice.num_edges(), 7U);
+		batch_decoder.decode_batch(std::span<const uint8_t>(syndromes),
+								   std::span<uint32_t>(corrections));
+
+		Decoder<LatticeCubic> decoder(L);
+		for(uint32_t shot = 0; shot < num_shots; ++shot)
+		{
+			std::vector<uint32_t> shot_syndromes(
+				syndromes.begin() + shot * lattice.num_vertices(),
+				syndromes.begin() + (shot + 1) * lattice.num_vertices());
+			decoder.clear();
+			const auto edges = decoder.decode(shot_syndromes);
+
+			std::vector<uint32_t> expected(lattice.num_edges(), 0U);
+			for(const auto& edge : edges) { expected[lattice.edge_idx(edge)] = 1U; }
+
+			REQUIRE(std::equal(expected.begin(), expected.end(),
+							   corrections.begin() + shot * lattice.num_edges()));
+		}
+	}
+
+	SECTION("Edge indices of each shot")
+	{
+		BatchDecoder<LatticeCubic> batch_decoder(3, L);
+		std::vector<std::vector<uint32_t>> shot_edges(num_shots);
+		batch_decoder.decode_batch_edges(std::span<const uint8_t>(syndromes),
+										 [&](size_t shot, std::vector<uint32_t>& edges)
+										 { shot_edges[shot] = edges; });
+
+		Decoder<LatticeCubic> decoder(L);
+		std::vector<uint32_t> expected;
+		for(uint32_t shot = 0; shot < num_shots; ++shot)
+		{
+			decoder.decode(std::span<const uint8_t>(syndromes).subspan(
+							   shot * lattice.num_vertices(), lattice.num_vertices()),
+						   expected);
+			std::sort(expected.begin(), expected.end());
+			std::sort(shot_edges[shot].begin(), shot_edges[shot].end());
+			REQUIRE(shot_edges[shot] == expected);
+		}
+	}
+
+	SECTION("Mismatched sizes throw")
+	{
+		BatchDecoder<LatticeCubic> batch_decoder(2, L);
+		std::vector<uint32_t> corrections(lattice.num_edges(), 0U);
+		REQUIRE_THROWS_AS(batch_decoder.decode_batch(std::span<const uint8_t>(syndromes),
+													 std::span<uint32_t>(corrections)),
+						  std::invalid_argument);
+	}
+}
@@ -16,19 +16,33 @@
 // along with UnionFind++.  If not, see <https://www.gnu.org/licenses/>.
 #include "../examples/Lattice2D.hpp"
 #include "../examples/LatticeCubic.hpp"
+#include "Decoder.hpp"
 #include "LatticeConcept.hpp"
 #include "LatticeFromParity.hpp"
+#include "LatticeRepeated.hpp"
+#include "LogicalObservables.hpp"
+#include "ParallelFor.hpp"
 
 #include <Eigen/Sparse>
 #include <unsupported/Eigen/KroneckerProduct>
 
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
 #include <random>
 #include <set>
+#include <stdexcept>
+#include <span>
+#include <type_traits>
 
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 
 using UnionFindCPP::LatticeFromParity;
+using UnionFindCPP::LatticeRepeated;
+using UnionFindCPP::parallel_for;
 /**
  * The Lattice2D from v0.1 uses the simplest ordering.
  *
@@ -287,3 +301,638 @@ TEST_CASE("Test whether the constructed lattice is correct for a toric code (3D)
 		}
 	}
 }
+
+TEST_CASE("Test vertex_neighbors of LatticeFromParity", "[LatticeFromParity]")
+{
+	static_assert(UnionFindCPP::LatticeWithNeighborEdges<LatticeFromParity>);
+
+	SECTION("Edge indices are consistent with edge_idx")
+	{
+		for(uint32_t L : {3, 7})
+		{
+			auto H = toric_x_stabilizers_qubits_new(L);
+			auto lattice = LatticeFromParity(H.rows(), H.cols(), H.innerIndexPtr(),
+											 H.outerIndexPtr(), /*repetitions = */ L);
+			for(uint32_t v = 0; v < lattice.num_vertices(); ++v)
+			{
+				const auto neighbors = lattice.vertex_neighbors(v);
+				REQUIRE(neighbors.size() == lattice.vertex_connection_count(v));
+				for(const auto& neighbor : neighbors)
+				{
+					REQUIRE(lattice.edge_idx({v, neighbor.vertex}) == neighbor.edge_idx);
+				}
+			}
+		}
+	}
+
+	SECTION("Only the smallest qubit among parallel qubits becomes an edge")
+	{
+		// qubits 0, 1, 3 connect parities 0 and 1; qubit 2 connects parities 1 and 2
+		std::vector<int> col_indices{0, 1, 3, 0, 1, 2, 3, 2};
+		std::vector<int> indptr{0, 3, 7, 8};
+		auto lattice = LatticeFromParity(3, 4, col_indices.data(), indptr.data());
+
+		REQUIRE(lattice.num_edges() == 4);
+		REQUIRE(lattice.vertex_connection_count(0) == 1);
+		REQUIRE(lattice.vertex_connection_count(1) == 2);
+		REQUIRE(lattice.edge_idx({0, 1}) == 0);
+		REQUIRE(lattice.edge_idx({1, 2}) == 2);
+	}
+
+	SECTION("A qubit contained in a single parity throws")
+	{
+		std::vector<int> col_indices{0, 1, 0};
+		std::vector<int> indptr{0, 2, 3};
+		REQUIRE_THROWS_AS(LatticeFromParity(2, 2, col_indices.data(), indptr.data()),
+						  std::invalid_argument);
+	}
+}
+
+TEST_CASE("Decoder over LatticeFromParity removes all defects", "[LatticeFromParity]")
+{
+	std::mt19937 re{1337U}; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	const uint32_t L = 7;
+	auto H = toric_x_stabilizers_qubits_new(L);
+	auto decoder = UnionFindCPP::Decoder<LatticeFromParity>(
+		H.rows(), H.cols(), H.innerIndexPtr(), H.outerIndexPtr(), /*repetitions = */ L);
+	const auto& lattice = decoder.lattice();
+	const auto edges = lattice.edge_idx_all();
+
+	std::bernoulli_distribution flip(0.03);
+	for(int iter = 0; iter < 50; ++iter)
+	{
+		std::vector<uint32_t> syndromes(lattice.num_vertices(), 0U);
+		for(const auto& [edge, idx] : edges)
+		{
+			if(!flip(re)) { continue; }
+			syndromes[edge.u] ^= 1U;
+			syndromes[edge.v] ^= 1U;
+		}
+
+		decoder.clear();
+		for(const auto& edge : decoder.decode(syndromes))
+		{
+			syndromes[edge.u] ^= 1U;
+			syndromes[edge.v] ^= 1U;
+		}
+		REQUIRE(std::all_of(syndromes.begin(), syndromes.end(),
+							[](uint32_t s) { return s == 0; }));
+	}
+}
+
+TEST_CASE("Save and load LatticeFromParity", "[LatticeFromParity]")
+{
+	const auto path = (std::filesystem::temp_directory_path() / "test_lattice_parity.bin")
+						  .string();
+
+	SECTION("A loaded lattice is the same as the saved one")
+	{
+		for(uint32_t L : {3, 7})
+		{
+			auto H = toric_x_stabilizers_qubits_new(L);
+			auto lattice = LatticeFromParity(H.rows(), H.cols(), H.innerIndexPtr(),
+											 H.outerIndexPtr(), /*repetitions = */ L);
+			lattice.save(path);
+			const auto loaded = LatticeFromParity::load(path);
+
+			REQUIRE(loaded.repetitions() == L);
+			check_same_lattice(lattice, loaded);
+			for(uint32_t v = 0; v < lattice.num_vertices(); ++v)
+			{
+				const auto n1 = lattice.vertex_neighbors(v);
+				const auto n2 = loaded.vertex_neighbors(v);
+				REQUIRE(std::equal(n1.begin(), n1.end(), n2.begin(), n2.end(),
+								   [](const auto& a, const auto& b) {
+									   return a.vertex == b.vertex
+											  && a.edge_idx == b.edge_idx;
+								   }));
+			}
+		}
+	}
+
+	SECTION("A decoder uses a loaded lattice")
+	{
+		const uint32_t L = 7;
+		auto H = toric_x_stabilizers_qubits_new(L);
+		LatticeFromParity(H.rows(), H.cols(), H.innerIndexPtr(), H.outerIndexPtr())
+			.save(path);
+		auto lattice
+			= std::make_shared<const LatticeFromParity>(LatticeFromParity::load(path));
+		auto decoder = UnionFindCPP::Decoder<LatticeFromParity>(lattice);
+
+		std::vector<uint32_t> syndromes(lattice->num_vertices(), 0U);
+		syndromes[0] = 1U;
+		syndromes[L + 3] = 1U;
+		for(const auto& edge : decoder.decode(syndromes))
+		{
+			syndromes[edge.u] ^= 1U;
+			syndromes[edge.v] ^= 1U;
+		}
+		REQUIRE(std::all_of(syndromes.begin(), syndromes.end(),
+							[](uint32_t s) { return s == 0U; }));
+	}
+
+	SECTION("Files that are not lattices throw")
+	{
+		{
+			std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+			fout << "not a lattice file at all, but long enough for a header";
+		}
+		REQUIRE_THROWS_AS(LatticeFromParity::load(path), std::invalid_argument);
+		REQUIRE_THROWS_AS(LatticeFromParity::load(path + ".missing"), std::runtime_error);
+	}
+
+	SECTION("Neighbors out of range throw")
+	{
+		auto H = toric_x_stabilizers_qubits_new(3);
+		// without reordering, the file ends with the vertex and the edge index of the
+		// last neighbor
+		for(const std::streamoff offset : {-8, -4})
+		{
+			LatticeFromParity(H.rows(), H.cols(), H.innerIndexPtr(), H.outerIndexPtr())
+				.save(path);
+			{
+				std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+				file.seekp(offset, std::ios::end);
+				const uint32_t invalid = std::numeric_limits<uint32_t>::max();
+				file.write(reinterpret_cast<const char*>(&invalid), // NOLINT
+						   sizeof(invalid));
+			}
+			REQUIRE_THROWS_AS(LatticeFromParity::load(path), std::invalid_argument);
+		}
+	}
+
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("LatticeRepeated is the same as LatticeFromParity with repetitions",
+		  "[LatticeRepeated]")
+{
+	static_assert(UnionFindCPP::LatticeWithNeighborEdges<LatticeRepeated>);
+
+	const auto path
+		= (std::filesystem::temp_directory_path() / "test_lattice_repeated.bin").string();
+
+	for(uint32_t L : {3, 7})
+	{
+		auto H = toric_x_stabilizers_qubits_new(L);
+		const auto lattice = LatticeFromParity(H.rows(), H.cols(), H.innerIndexPtr(),
+											   H.outerIndexPtr(), /*repetitions = */ L);
+		const auto repeated = LatticeRepeated(H.rows(), H.cols(), H.innerIndexPtr(),
+											  H.outerIndexPtr(), /*repetitions = */ L);
+
+		SECTION("Same graph and edge indices")
+		{
+			check_same_lattice(lattice, repeated);
+			for(uint32_t v = 0; v < repeated.num_vertices(); ++v)
+			{
+				const auto neighbors = repeated.vertex_neighbors(v);
+				REQUIRE(neighbors.size() == repeated.vertex_connection_count(v));
+				for(const auto& neighbor : neighbors)
+				{
+					REQUIRE(lattice.edge_idx({v, neighbor.vertex}) == neighbor.edge_idx);
+				}
+			}
+		}
+
+		SECTION("Same corrections")
+		{
+			std::mt19937 re{L}; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+			std::bernoulli_distribution flip(0.05);
+			auto decoder = UnionFindCPP::Decoder<LatticeFromParity>(lattice);
+			auto decoder_repeated = UnionFindCPP::Decoder<LatticeRepeated>(repeated);
+			for(int iter = 0; iter < 20; ++iter)
+			{
+				std::vector<uint32_t> syndromes(lattice.num_vertices(), 0U);
+				for(const auto& [edge, idx] : lattice.edge_idx_all())
+				{
+					if(!flip(re)) { continue; }
+					syndromes[edge.u] ^= 1U;
+					syndromes[edge.v] ^= 1U;
+				}
+				decoder.clear();
+				decoder_repeated.clear();
+				REQUIRE(decoder.decode(syndromes) == decoder_repeated.decode(syndromes));
+			}
+		}
+
+		SECTION("Layers are folded onto the qubits of a layer")
+		{
+			std::mt19937 re{L}; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+			std::bernoulli_distribution flip(0.2);
+			const uint32_t stride = repeated.layer().num_vertices() + H.cols();
+			for(int iter = 0; iter < 20; ++iter)
+			{
+				std::vector<uint32_t> edge_indices;
+				std::vector<uint32_t> expected(H.cols(), 0U);
+				for(uint32_t idx = 0; idx < repeated.num_edges(); ++idx)
+				{
+					if(!flip(re)) { continue; }
+					edge_indices.push_back(idx);
+					if(idx % stride < static_cast<uint32_t>(H.cols()))
+					{
+						expected[idx % stride] ^= 1U;
+					}
+				}
+				std::shuffle(edge_indices.begin(), edge_indices.end(), re);
+
+				repeated.fold_layers(edge_indices);
+				REQUIRE(std::is_sorted(edge_indices.begin(), edge_indices.end()));
+				std::vector<uint32_t> folded(H.cols(), 0U);
+				for(const auto qubit : edge_indices) { folded[qubit] ^= 1U; }
+				REQUIRE(folded == expected);
+			}
+		}
+
+		SECTION("Save and load")
+		{
+			repeated.save(path);
+			const auto loaded = LatticeRepeated::load(path);
+			REQUIRE(loaded.repetitions() == L);
+			check_same_lattice(repeated, loaded);
+			REQUIRE_THROWS_AS(LatticeFromParity::load(path), std::invalid_argument);
+
+			lattice.save(path);
+			REQUIRE_THROWS_AS(LatticeRepeated::load(path), std::invalid_argument);
+
+			repeated.layer().save(path);
+			REQUIRE(LatticeRepeated::load(path).repetitions() == 1);
+		}
+
+		SECTION("Too many repetitions for 32-bit indices throw")
+		{
+			// NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+			const uint32_t repetitions = 1U << 30U;
+			REQUIRE_THROWS_AS(LatticeRepeated(repeated.layer(), repetitions),
+							  std::invalid_argument);
+		}
+	}
+
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("LatticeFromParity constructed by multiple threads", "[LatticeFromParity]")
+{
+	// large enough to be split among threads
+	const uint32_t L = 256;
+	auto H = toric_x_stabilizers_qubits_new(L);
+	for(uint32_t repetitions : {1, 3})
+	{
+		const auto expected
+			= LatticeFromParity(H.rows(), H.cols(), H.innerIndexPtr(), H.outerIndexPtr(),
+								repetitions, /*num_threads = */ 1);
+		for(size_t num_threads : {2, 3, 8})
+		{
+			const auto lattice
+				= LatticeFromParity(H.rows(), H.cols(), H.innerIndexPtr(),
+									H.outerIndexPtr(), repetitions, num_threads);
+			REQUIRE(lattice.num_edges() == expected.num_edges());
+			REQUIRE(lattice.num_vertices() == expected.num_vertices());
+			for(uint32_t v = 0; v < lattice.num_vertices(); ++v)
+			{
+				const auto n1 = lattice.vertex_neighbors(v);
+				const auto n2 = expected.vertex_neighbors(v);
+				REQUIRE(std::equal(n1.begin(), n1.end(), n2.begin(), n2.end(),
+								   [](const auto& a, const auto& b) {
+									   return a.vertex == b.vertex
+											  && a.edge_idx == b.edge_idx;
+								   }));
+			}
+		}
+	}
+}
+
+TEST_CASE("parallel_for joins all threads and rethrows exceptions of func", "[internal]")
+{
+	for(size_t num_threads : {1, 2, 8})
+	{
+		std::vector<int> visited(100, 0);
+		parallel_for(num_threads, uint32_t{100},
+					 [&](uint32_t begin, uint32_t end)
+					 {
+						 for(uint32_t i = begin; i < end; ++i) { ++visited[i]; }
+					 });
+		REQUIRE(std::ranges::all_of(visited, [](int count) { return count == 1; }));
+
+		// a range that throws must not terminate the program with joinable threads
+		REQUIRE_THROWS_AS(parallel_for(num_threads, uint32_t{100},
+									   [](uint32_t begin, uint32_t /*end*/)
+									   {
+										   if(begin == 0)
+										   {
+											   throw std::runtime_error("first range");
+										   }
+									   }),
+						  std::runtime_error);
+		REQUIRE_THROWS_AS(parallel_for(num_threads, uint32_t{100},
+									   [](uint32_t /*begin*/, uint32_t end)
+									   {
+										   if(end == 100)
+										   {
+											   throw std::runtime_error("last range");
+										   }
+									   }),
+						  std::runtime_error);
+	}
+}
+
+TEST_CASE("LatticeFromParity from CSR arrays of different integer types",
+		  "[LatticeFromParity]")
+{
+	const uint32_t L = 7;
+	auto H = toric_x_stabilizers_qubits_new(L);
+	const auto expected = LatticeFromParity(H.rows(), H.cols(), H.innerIndexPtr(),
+											H.outerIndexPtr(), /*repetitions = */ L);
+
+	const std::vector<int64_t> col_indices(H.innerIndexPtr(),
+										   H.innerIndexPtr() + H.nonZeros());
+	const std::vector<int64_t> indptr(H.outerIndexPtr(),
+									  H.outerIndexPtr() + H.rows() + 1);
+	const std::vector<uint32_t> col_indices_u32(col_indices.begin(), col_indices.end());
+
+	check_same_lattice(LatticeFromParity(H.rows(), H.cols(), col_indices.data(),
+										 indptr.data(), /*repetitions = */ L),
+					   expected);
+	check_same_lattice(LatticeFromParity(H.rows(), H.cols(), col_indices_u32.data(),
+										 indptr.data(), /*repetitions = */ L),
+					   expected);
+	check_same_lattice(LatticeRepeated(H.rows(), H.cols(), col_indices.data(),
+									   indptr.data(), /*repetitions = */ L),
+					   expected);
+}
+
+TEMPLATE_TEST_CASE("LatticeFromParity with other index types", "[LatticeFromParity]",
+				   uint16_t, uint64_t)
+{
+	using Lattice = UnionFindCPP::BasicLatticeFromParity<TestType>;
+	using Index = typename Lattice::Index;
+	static_assert(std::is_same_v<UnionFindCPP::lattice_index_t<Lattice>, TestType>);
+
+	const auto path
+		= (std::filesystem::temp_directory_path() / "test_lattice_index_type.bin")
+			  .string();
+
+	for(uint32_t L : {3, 7})
+	{
+		auto H = toric_x_stabilizers_qubits_new(L);
+		const auto expected = LatticeFromParity(H.rows(), H.cols(), H.innerIndexPtr(),
+												H.outerIndexPtr(), /*repetitions = */ L)
+								  .reordered(UnionFindCPP::VertexOrder::BreadthFirst);
+		const auto lattice = Lattice(H.rows(), H.cols(), H.innerIndexPtr(),
+									 H.outerIndexPtr(), /*repetitions = */ L)
+								 .reordered(UnionFindCPP::VertexOrder::BreadthFirst);
+
+		const auto same_neighbors = [&expected](const Lattice& other)
+		{
+			REQUIRE(other.num_vertices() == expected.num_vertices());
+			REQUIRE(other.num_edges() == expected.num_edges());
+			for(uint32_t v = 0; v < expected.num_vertices(); ++v)
+			{
+				REQUIRE(other.original_vertex(v) == expected.original_vertex(v));
+				const auto n1 = other.vertex_neighbors(v);
+				const auto n2 = expected.vertex_neighbors(v);
+				REQUIRE(std::equal(n1.begin(), n1.end(), n2.begin(), n2.end(),
+								   [](const auto& a, const auto& b) {
+									   return a.vertex == b.vertex
+											  && a.edge_idx == b.edge_idx;
+								   }));
+			}
+		};
+
+		SECTION("Same graph as with 32-bit indices") { same_neighbors(lattice); }
+
+		SECTION("Same corrections as with 32-bit indices")
+		{
+			std::mt19937 re{L}; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+			std::bernoulli_distribution flip(0.05);
+			auto decoder = UnionFindCPP::Decoder<LatticeFromParity>(expected);
+			auto decoder_index = UnionFindCPP::Decoder<Lattice>(lattice);
+			std::vector<uint32_t> corrections;
+			std::vector<Index> corrections_index;
+			for(int iter = 0; iter < 20; ++iter)
+			{
+				std::vector<uint8_t> syndromes(expected.num_vertices(), 0U);
+				for(const auto& [edge, idx] : expected.edge_idx_all())
+				{
+					if(!flip(re)) { continue; }
+					syndromes[expected.original_vertex(edge.u)] ^= 1U;
+					syndromes[expected.original_vertex(edge.v)] ^= 1U;
+				}
+				decoder.decode(std::span<const uint8_t>(syndromes), corrections);
+				decoder_index.decode(std::span<const uint8_t>(syndromes),
+									 corrections_index);
+				REQUIRE(std::equal(corrections.begin(), corrections.end(),
+								   corrections_index.begin(), corrections_index.end()));
+			}
+		}
+
+		SECTION("Save and load")
+		{
+			lattice.save(path);
+			same_neighbors(Lattice::load(path));
+			REQUIRE_THROWS_AS(LatticeFromParity::load(path), std::invalid_argument);
+		}
+	}
+
+	if constexpr(sizeof(Index) == sizeof(uint16_t))
+	{
+		SECTION("Lattices too large for the index type throw")
+		{
+			auto H = toric_x_stabilizers_qubits_new(200);
+			REQUIRE_THROWS_AS(Lattice(H.rows(), H.cols(), H.innerIndexPtr(),
+									  H.outerIndexPtr()),
+							  std::invalid_argument);
+		}
+	}
+
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("Reordered LatticeFromParity", "[LatticeFromParity]")
+{
+	using UnionFindCPP::VertexOrder;
+	static_assert(UnionFindCPP::LatticeWithInternalOrder<LatticeFromParity>);
+	static_assert(UnionFindCPP::LatticeWithInternalOrder<LatticeRepeated>);
+
+	const auto path
+		= (std::filesystem::temp_directory_path() / "test_reordered.bin").string();
+
+	/* (vertex, edge index) of the neighbors of a vertex in the original numbering */
+	const auto original_neighbors = [](const auto& lattice, uint32_t v)
+	{
+		std::set<std::pair<uint32_t, uint32_t>> res;
+		for(const auto& neighbor : lattice.vertex_neighbors(v))
+		{
+			res.emplace(lattice.original_vertex(neighbor.vertex),
+						lattice.original_edge_idx(neighbor.edge_idx));
+		}
+		return res;
+	};
+	/* bandwidth of the adjacency matrix */
+	const auto bandwidth = [](const LatticeFromParity& lattice)
+	{
+		uint32_t res = 0;
+		for(uint32_t v = 0; v < lattice.num_vertices(); ++v)
+		{
+			for(const auto& neighbor : lattice.vertex_neighbors(v))
+			{
+				res = std::max(res, std::max(v, neighbor.vertex)
+										- std::min(v, neighbor.vertex));
+			}
+		}
+		return res;
+	};
+
+	const uint32_t L = 7;
+	auto H = toric_x_stabilizers_qubits_new(L);
+	const auto lattice = LatticeFromParity(H.rows(), H.cols(), H.innerIndexPtr(),
+										   H.outerIndexPtr(), /*repetitions = */ L);
+
+	for(const auto order : {VertexOrder::BreadthFirst, VertexOrder::ReverseCuthillMcKee})
+	{
+		const auto reordered = lattice.reordered(order);
+
+		SECTION("Same graph in a different numbering")
+		{
+			REQUIRE(reordered.num_vertices() == lattice.num_vertices());
+			REQUIRE(reordered.num_edges() == lattice.num_edges());
+			for(uint32_t v = 0; v < lattice.num_vertices(); ++v)
+			{
+				REQUIRE(reordered.original_vertex(reordered.internal_vertex(v)) == v);
+				REQUIRE(original_neighbors(reordered, reordered.internal_vertex(v))
+						== original_neighbors(lattice, v));
+			}
+		}
+
+		SECTION("Decoder uses the original numbering")
+		{
+			std::mt19937 re{1337U}; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+			std::bernoulli_distribution flip(0.05);
+			auto decoder = UnionFindCPP::Decoder<LatticeFromParity>(reordered);
+			for(int iter = 0; iter < 20; ++iter)
+			{
+				std::vector<uint32_t> syndromes(lattice.num_vertices(), 0U);
+				for(const auto& [edge, idx] : lattice.edge_idx_all())
+				{
+					if(!flip(re)) { continue; }
+					syndromes[edge.u] ^= 1U;
+					syndromes[edge.v] ^= 1U;
+				}
+				decoder.clear();
+				for(const auto& edge : decoder.decode(syndromes))
+				{
+					REQUIRE(static_cast<uint32_t>(decoder.edge_idx(edge))
+							== lattice.edge_idx(edge));
+					syndromes[edge.u] ^= 1U;
+					syndromes[edge.v] ^= 1U;
+				}
+				REQUIRE(std::all_of(syndromes.begin(), syndromes.end(),
+									[](uint32_t s) { return s == 0U; }));
+			}
+		}
+
+		SECTION("Logical observables use the original edge indices")
+		{
+			std::mt19937 re{42U}; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+			std::bernoulli_distribution flip(0.05);
+			// observable k contains the edges whose original index is k modulo 3
+			std::vector<uint32_t> indptr{0};
+			std::vector<uint32_t> indices;
+			for(uint32_t k = 0; k < 3; ++k)
+			{
+				for(uint32_t e = k; e < lattice.num_edges(); e += 3)
+				{
+					indices.push_back(e);
+				}
+				indptr.push_back(static_cast<uint32_t>(indices.size()));
+			}
+			auto decoder = UnionFindCPP::Decoder<LatticeFromParity>(reordered);
+			decoder.set_observables(
+				std::make_shared<const UnionFindCPP::LogicalObservables>(
+					3, lattice.num_edges(), indptr, indices));
+			for(int iter = 0; iter < 20; ++iter)
+			{
+				std::vector<uint32_t> syndromes(lattice.num_vertices(), 0U);
+				for(const auto& [edge, idx] : lattice.edge_idx_all())
+				{
+					if(!flip(re)) { continue; }
+					syndromes[edge.u] ^= 1U;
+					syndromes[edge.v] ^= 1U;
+				}
+				uint64_t expected = 0;
+				for(const auto& edge : decoder.decode(syndromes))
+				{
+					expected ^= uint64_t{1} << (lattice.edge_idx(edge) % 3);
+				}
+				REQUIRE(decoder.decode_observables(std::span<const uint32_t>(syndromes))
+						== expected);
+			}
+		}
+
+		SECTION("Save and load")
+		{
+			reordered.save(path);
+			const auto loaded = LatticeFromParity::load(path);
+			check_same_lattice(reordered, loaded);
+			for(uint32_t v = 0; v < lattice.num_vertices(); ++v)
+			{
+				REQUIRE(loaded.original_vertex(v) == reordered.original_vertex(v));
+				REQUIRE(loaded.internal_vertex(v) == reordered.internal_vertex(v));
+			}
+			for(uint32_t e = 0; e < lattice.num_edges(); ++e)
+			{
+				REQUIRE(loaded.original_edge_idx(e) == reordered.original_edge_idx(e));
+			}
+		}
+
+		SECTION("Reordered layer of LatticeRepeated")
+		{
+			const auto layer
+				= LatticeFromParity(H.rows(), H.cols(), H.innerIndexPtr(),
+									H.outerIndexPtr())
+					  .reordered(order);
+			const auto repeated = LatticeRepeated(layer, L);
+			for(uint32_t v = 0; v < lattice.num_vertices(); ++v)
+			{
+				REQUIRE(repeated.original_vertex(repeated.internal_vertex(v)) == v);
+				REQUIRE(original_neighbors(repeated, repeated.internal_vertex(v))
+						== original_neighbors(lattice, v));
+			}
+
+			auto decoder = UnionFindCPP::Decoder<LatticeRepeated>(repeated);
+			std::vector<uint32_t> syndromes(lattice.num_vertices(), 0U);
+			syndromes[3] = 1U;
+			syndromes[H.rows() + 4] = 1U;
+			for(const auto& edge : decoder.decode(syndromes))
+			{
+				REQUIRE(static_cast<uint32_t>(decoder.edge_idx(edge))
+						== lattice.edge_idx(edge));
+				syndromes[edge.u] ^= 1U;
+				syndromes[edge.v] ^= 1U;
+			}
+			REQUIRE(std::all_of(syndromes.begin(), syndromes.end(),
+								[](uint32_t s) { return s == 0U; }));
+		}
+	}
+
+	SECTION("Reverse Cuthill-McKee reduces the bandwidth of shuffled parities")
+	{
+		using SpMatu = Eigen::SparseMatrix<uint32_t, Eigen::RowMajor>;
+		const auto H2 = toric_x_stabilizers_qubits_new(16);
+		Eigen::PermutationMatrix<Eigen::Dynamic> perm(H2.rows());
+		perm.setIdentity();
+		std::mt19937 re{42U}; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+		std::shuffle(perm.indices().data(), perm.indices().data() + H2.rows(), re);
+		SpMatu shuffled = perm * H2;
+		shuffled.makeCompressed();
+
+		const auto shuffled_lattice
+			= LatticeFromParity(shuffled.rows(), shuffled.cols(),
+								shuffled.innerIndexPtr(), shuffled.outerIndexPtr());
+		const auto reordered
+			= shuffled_lattice.reordered(VertexOrder::ReverseCuthillMcKee);
+		REQUIRE(bandwidth(reordered) < bandwidth(shuffled_lattice) / 4);
+	}
+
+	std::filesystem::remove(path);
+}
@@ -1,4 +1,6 @@
-from ._union_find_py import DecoderFromParity
+from ._union_find_py import (DecoderFromParity, BatchDecoderFromParity,
+        RepeatedDecoderFromParity, BatchRepeatedDecoderFromParity, GrowthPolicy,
+        VertexOrder)
 import logging
 from scipy.sparse import csr_matrix
 import numpy as np
@@ -7,11 +9,38 @@ class Decoder:
     """Union-Find decoder class
 
     :param parity_matrix (scipy.sparse.csr_matrix): a parity matrix in CSR format
+    :param repetitions (int): (optional) number of repeated noisy measurements
+    :param growth_policy (str): 'all_odd' (default) grows all odd clusters in each
+        round, and 'smallest_first' always grows the smallest odd cluster first.
+    :param vertex_order (str): 'original' (default) keeps the order of the rows of the
+        parity matrix inside the decoder. 'bfs' (breadth-first) and 'rcm' (reverse
+        Cuthill-McKee) renumber the parities so that neighboring parities are close in
+        memory, which speeds up decoding of matrices with poorly ordered rows. Syndromes
+        and corrections always use the original order.
+    :param observables: (optional) logical operators used by :meth:`decode_observables`.
+        See :meth:`set_observables`.
+
+    A decoder is not thread-safe. The GIL is released while decoding, but the
+    clusters of a shot are kept in the decoder until it is cleared, so two Python
+    threads calling its methods at the same time corrupt each other's results. Use
+    :meth:`decode_batch` to decode many shots in parallel, or one decoder per thread.
     """
+
+    _growth_policies = {
+        'all_odd': GrowthPolicy.AllOddClusters,
+        'smallest_first': GrowthPolicy.SmallestFirst,
+    }
+    _vertex_orders = {
+        'original': VertexOrder.Original,
+        'bfs': VertexOrder.BreadthFirst,
+        'rcm': VertexOrder.ReverseCuthillMcKee,
+    }
     
     _repetitions = None
+    _batch_decoder = None
 
-    def __init__(self, parity_matrix, repetitions = None):
+    def __init__(self, parity_matrix, repetitions = None, growth_policy = 'all_odd',
+            vertex_order = 'original', observables = None):
         """Create a decoder from a parity matrix"""
 
         if not isinstance(parity_matrix, csr_matrix):
@@ -23,36 +52,219 @@ class Decoder:
         if not np.all(parity_matrix.data == 1):
             raise ValueError('Any non-zero value of the partiy matrix must be 1.')
         
+        if growth_policy not in self._growth_policies:
+            raise ValueError('growth_policy must be one of {}'.format(
+                list(self._growth_policies)))
+        self._growth_policy = self._growth_policies[growth_policy]
+
+        if vertex_order not in self._vertex_orders:
+            raise ValueError('vertex_order must be one of {}'.format(
+                list(self._vertex_orders)))
+        vertex_order = self._vertex_orders[vertex_order]
+
         if repetitions is None:
             self._decoder = DecoderFromParity(parity_matrix.shape[0], 
-                    parity_matrix.shape[1], parity_matrix.indices, parity_matrix.indptr)
+                    parity_matrix.shape[1], parity_matrix.indices, parity_matrix.indptr,
+                    vertex_order=vertex_order)
         else:
             self._repetitions = repetitions
             self._layer_vertex_size = parity_matrix.shape[0]
             self._layer_num_qubits = parity_matrix.shape[1]
-            self._decoder = DecoderFromParity(parity_matrix.shape[0], 
+            # only a single layer of the lattice is stored
+            self._decoder = RepeatedDecoderFromParity(parity_matrix.shape[0], 
                     parity_matrix.shape[1], parity_matrix.indices, parity_matrix.indptr,
-                    repetitions)
+                    repetitions, vertex_order=vertex_order)
+        self._decoder.growth_policy = self._growth_policy
+        if observables is not None:
+            self.set_observables(observables)
+
+    @classmethod
+    def load(cls, path, growth_policy = 'all_odd'):
+        """Create a decoder from a lattice file written by :meth:`save`.
+
+        The file is memory-mapped read-only, so processes loading the same file
+        (e.g. MPI ranks on a node) share a single copy of the lattice.
+        """
+        if growth_policy not in cls._growth_policies:
+            raise ValueError('growth_policy must be one of {}'.format(
+                list(cls._growth_policies)))
+
+        self = cls.__new__(cls)
+        self._growth_policy = cls._growth_policies[growth_policy]
+        # files saved without repetitions are loaded as a single layer
+        self._decoder = RepeatedDecoderFromParity.load(str(path))
+        if self._decoder.repetitions > 1:
+            self._repetitions = self._decoder.repetitions
+            self._layer_vertex_size = self._decoder.layer_num_vertices
+            self._layer_num_qubits = self._decoder.layer_num_edges
+        self._decoder.growth_policy = self._growth_policy
+        return self
 
-    def decode(self, syndrome_arr):
+    def save(self, path):
+        """Save the lattice of the decoder to a binary file that can be loaded with
+        :meth:`load`."""
+        self._decoder.save(str(path))
+
+    def set_observables(self, observables):
+        """Set the logical operators whose flips are returned by
+        :meth:`decode_observables`.
+
+        :param observables: a 0/1 matrix (scipy sparse or dense) of shape
+            (num_observables, num_qubits) whose rows are logical operators. At most 64
+            observables are supported. With repetitions, a qubit is counted in all
+            layers.
+        """
+        observables = csr_matrix(observables, dtype=np.int64)
+        num_qubits = (self._decoder.num_edges if self._repetitions is None
+                else self._layer_num_qubits)
+        if observables.shape[1] != num_qubits:
+            raise ValueError("observables must have a column for each qubit")
+        observables.sum_duplicates()
+        observables.data %= 2
+        observables.eliminate_zeros()
+
+        indptr, indices = observables.indptr, observables.indices
+        if self._repetitions is not None:
+            # the same qubit in all layers, whose edges start at multiples of layer_size
+            layer_size = self._layer_num_qubits + self._layer_vertex_size
+            offsets = np.arange(self._repetitions) * layer_size
+            indices = (indices[:, np.newaxis] + offsets).ravel()
+            indptr = indptr * self._repetitions
+
+        self._decoder.set_observables(observables.shape[0], indptr, indices)
+        self._batch_decoder = None
+
+    def decode_observables(self, syndrome_arr):
+        """Decode a given syndrome array and return only the logical observables flipped
+        by the correction.
+
+        :param syndrome_arr: a syndrome array accepted by :meth:`decode`
+        :return: an integer whose bit `k` is 1 if observable `k` is flipped
+        """
+        syndrome_arr = np.asarray(syndrome_arr)
+        if syndrome_arr.size != self._decoder.num_vertices:
+            raise ValueError("The size of syndrome_arr mismatches the size of all stabilizers")
+        return self._decoder.decode_observables(syndrome_arr)
+
+    def decode(self, syndrome_arr, out=None, output='dense'):
         """Decode a given syndrome array.
 
         :param syndrome_arr: for a given parity index `i`, syndrome_arr[i] must be 0 or 1. 
+            A C-contiguous boolean or integer numpy array is read without a copy.
+        :param out: (optional) a writeable C-contiguous integer array the corrections
+            are written into. Only used with ``output='dense'``.
+        :param output: 'dense' (default) returns a 0/1 array over the qubits.
+            'indices' returns the sorted indices of the qubits to correct as an int64
+            array, and 'packed' returns a uint8 array of the bits packed as
+            ``numpy.packbits`` does, which can be unpacked with
+            ``numpy.unpackbits(res, count=num_qubits)``. Both avoid writing an array
+            over all qubits when only a few are flipped.
         """
         if isinstance(syndrome_arr, list):
             syndrome_arr = np.array(syndrome_arr)
         if syndrome_arr.size != self._decoder.num_vertices:
             raise ValueError("The size of syndrome_arr mismatches the size of all stabilizers")
+        if output not in ('dense', 'indices', 'packed'):
+            raise ValueError("output must be one of ['dense', 'indices', 'packed']")
+        if out is not None and output != 'dense':
+            raise ValueError("out can only be given with output='dense'")
 
-        if self._repetitions is None:
-            corrections = self._decoder.decode(syndrome_arr)
-            self._decoder.clear()
-            return corrections
+        if output == 'indices':
+            corrections = self._decoder.decode_qubits(syndrome_arr)
+        elif output == 'packed':
+            corrections = self._decoder.decode_packed(syndrome_arr)
+        elif self._repetitions is None:
+            corrections = self._decoder.decode(syndrome_arr, out)
         else:
-            corrections = self._decoder.decode(syndrome_arr.flatten())
-            self._decoder.clear()
-            res = np.zeros((self._layer_num_qubits,), dtype=int)
-            for depth in range(self._repetitions):
-                res += corrections[depth*(self._layer_num_qubits + self._layer_vertex_size):depth*(self._layer_num_qubits + self._layer_vertex_size)+self._layer_num_qubits]
-            res %= 2
-            return res
+            # the layers are folded in C++, which returns only the flipped qubits
+            qubits = self._decoder.decode_qubits(syndrome_arr)
+            if out is None:
+                corrections = np.zeros((self._layer_num_qubits,), dtype=int)
+            else:
+                corrections = out
+                corrections[...] = 0
+            corrections[qubits] = 1
+        self._decoder.clear()
+        return corrections
+
+    def decode_defects(self, defects):
+        """Decode syndromes given as the indices of the parities with defects.
+
+        Only the defects and their clusters are visited, so this is much faster than
+        :meth:`decode` for large lattices with few defects.
+
+        :param defects: distinct indices of the parities whose syndrome is 1. With
+            repetitions, index `i` of layer `d` is given as `d * num_parities + i`.
+        :return: the sorted indices of the qubits to correct as an int64 array, the
+            same as ``decode(syndrome_arr, output='indices')``
+        """
+        defects = np.asarray(defects)
+        if defects.ndim != 1 or np.unique(defects).size != defects.size:
+            raise ValueError("defects must be a 1D array of distinct indices")
+        if defects.size > 0 and (defects.min() < 0 or
+                defects.max() >= self._decoder.num_vertices):
+            raise ValueError("defects must be indices of parities")
+
+        # with repetitions, the layers are folded in C++
+        corrections = self._decoder.decode_defects(defects)
+        self._decoder.clear()
+        return corrections
+
+    def decode_batch(self, syndromes, num_threads=None, out=None, output='dense'):
+        """Decode many shots at once.
+
+        All shots are decoded in C++ by a pool of threads with the GIL released.
+
+        :param syndromes: an array of shape (num_shots, num_parities) where each row
+            is a syndrome array accepted by :meth:`decode`.
+        :param num_threads: (optional) number of threads. All hardware threads are used
+            if not given.
+        :param out: (optional) a writeable C-contiguous integer array of shape
+            (num_shots, num_qubits) the corrections are written into. Only used with
+            ``output='dense'``.
+        :param output: 'dense' (default) returns a 0/1 uint8 array of shape
+            (num_shots, num_qubits), and 'packed' returns a uint8 array of shape
+            (num_shots, ceil(num_qubits / 8)) whose rows are packed as
+            ``numpy.packbits`` does.
+        """
+        syndromes = np.asarray(syndromes)
+        if syndromes.ndim != 2 or syndromes.shape[1] != self._decoder.num_vertices:
+            raise ValueError("syndromes must be a 2D array of shape (num_shots, num_parities)")
+        if output not in ('dense', 'packed'):
+            raise ValueError("output must be one of ['dense', 'packed']")
+        if out is not None and output != 'dense':
+            raise ValueError("out can only be given with output='dense'")
+
+        batch_decoder = self._get_batch_decoder(num_threads)
+        if output == 'packed':
+            return batch_decoder.decode_batch_packed(syndromes)
+        if self._repetitions is None:
+            return batch_decoder.decode_batch(syndromes, out)
+        # the layers are folded in C++ while decoding
+        return batch_decoder.decode_batch_folded(syndromes, out)
+
+    def decode_batch_observables(self, syndromes, num_threads=None):
+        """Decode many shots at once and return only the logical observables flipped in
+        each shot. Observables must be set with :meth:`set_observables`.
+
+        :param syndromes: an array of shape (num_shots, num_parities)
+        :param num_threads: (optional) number of threads. All hardware threads are used
+            if not given.
+        :return: a uint64 array of shape (num_shots,) whose bit `k` is 1 if observable
+            `k` is flipped
+        """
+        syndromes = np.asarray(syndromes)
+        if syndromes.ndim != 2 or syndromes.shape[1] != self._decoder.num_vertices:
+            raise ValueError("syndromes must be a 2D array of shape (num_shots, num_parities)")
+        return self._get_batch_decoder(num_threads).decode_batch_observables(syndromes)
+
+    def _get_batch_decoder(self, num_threads):
+        num_threads = 0 if num_threads is None else num_threads
+        if self._batch_decoder is None or (num_threads != 0 and
+                self._batch_decoder.num_threads != num_threads):
+            batch_class = (BatchRepeatedDecoderFromParity
+                    if isinstance(self._decoder, RepeatedDecoderFromParity)
+                    else BatchDecoderFromParity)
+            self._batch_decoder = batch_class(self._decoder, num_threads)
+            self._batch_decoder.set_growth_policy(self._growth_policy)
+        return self._batch_decoder
@@ -10,15 +10,11 @@ from UnionFindPy import Decoder
 
 def num_decoding_failures(L, H, logicals, p, num_trials):
     decoder = Decoder(toric_code_x_stabilisers(L))
-    num_errors = 0
-    for i in range(num_trials):
-        noise = np.random.binomial(1, p, 2 * L * L)
-        syndrome = H @ noise % 2
-        correction = decoder.decode(syndrome)
-        error = (noise + correction) % 2
-        if np.any(error @ logicals.T % 2):
-            num_errors += 1
-    return num_errors
+    noise = np.random.binomial(1, p, (num_trials, 2 * L * L))
+    syndromes = (H @ noise.T).T % 2
+    corrections = decoder.decode_batch(syndromes)
+    errors = (noise + corrections) % 2
+    return int(np.sum(np.any(errors @ logicals.T % 2, axis=1)))
 
 
 if __name__ == "__main__":
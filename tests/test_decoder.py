@@ -3,7 +3,7 @@ from UnionFindPy import Decoder
 import numpy as np
 from scipy.sparse import csr_matrix
 
-def test_toric33():
+def toric33_parity_matrix():
     parity_matrix = np.zeros((9, 18), dtype=np.int8)
     # P0
     parity_matrix[0,0] = 1
@@ -51,9 +51,11 @@ def test_toric33():
     parity_matrix[8,14] = 1
     parity_matrix[8,17] = 1
 
-    parity_matrix = csr_matrix(parity_matrix)
+    return csr_matrix(parity_matrix)
 
-    decoder = Decoder(parity_matrix)
+@pytest.mark.parametrize("growth_policy", ['all_odd', 'smallest_first'])
+def test_toric33(growth_policy):
+    decoder = Decoder(toric33_parity_matrix(), growth_policy=growth_policy)
 
     syndrom_arr = [0]*9
 
@@ -65,3 +67,240 @@ def test_toric33():
     expected[3] = 1
 
     assert np.all(decoder.decode(syndrom_arr) == expected)
+
+
+@pytest.mark.parametrize("dtype", [np.bool_, np.uint8, np.int32, np.int64, np.uint32])
+def test_toric33_dtypes_and_out(dtype):
+    decoder = Decoder(toric33_parity_matrix())
+
+    syndrom_arr = np.zeros(9, dtype=dtype)
+    syndrom_arr[0] = 1
+    syndrom_arr[3] = 1
+
+    expected = np.zeros(18, dtype=int)
+    expected[3] = 1
+
+    assert np.all(decoder.decode(syndrom_arr) == expected)
+
+    out = np.full(18, 5, dtype=np.uint8)
+    res = decoder.decode(syndrom_arr, out=out)
+    assert np.all(out == expected)
+    assert np.shares_memory(res, out)
+
+    # the input is not modified
+    assert syndrom_arr[0] == 1 and syndrom_arr[3] == 1
+
+
+@pytest.mark.parametrize("growth_policy", ['all_odd', 'smallest_first'])
+@pytest.mark.parametrize("num_threads", [None, 1, 3])
+def test_toric33_decode_batch(num_threads, growth_policy):
+    decoder = Decoder(toric33_parity_matrix(), growth_policy=growth_policy)
+
+    rng = np.random.default_rng(1234)
+    H = toric33_parity_matrix()
+    noise = rng.binomial(1, 0.1, size=(50, 18))
+    syndromes = (H @ noise.T).T % 2
+
+    corrections = decoder.decode_batch(syndromes, num_threads=num_threads)
+    assert corrections.shape == (50, 18)
+    for syndrome, correction in zip(syndromes, corrections):
+        assert np.all(decoder.decode(syndrome) == correction)
+
+    out = np.zeros((50, 18), dtype=np.int32)
+    res = decoder.decode_batch(syndromes.astype(np.bool_), num_threads=num_threads, out=out)
+    assert np.shares_memory(res, out)
+    assert np.all(out == corrections)
+
+    with pytest.raises(ValueError):
+        decoder.decode_batch(syndromes[:, :8])
+
+
+def test_toric33_decode_batch_repetitions():
+    repetitions = 3
+    decoder = Decoder(toric33_parity_matrix(), repetitions=repetitions)
+
+    rng = np.random.default_rng(42)
+    syndromes = rng.binomial(1, 0.1, size=(20, 9 * repetitions))
+    # make the total parity of each shot even
+    syndromes[:, 0] ^= syndromes.sum(axis=1) % 2
+
+    corrections = decoder.decode_batch(syndromes, num_threads=2)
+    assert corrections.shape == (20, 18)
+    for syndrome, correction in zip(syndromes, corrections):
+        assert np.all(decoder.decode(syndrome) == correction)
+
+
+def test_invalid_growth_policy():
+    with pytest.raises(ValueError):
+        Decoder(toric33_parity_matrix(), growth_policy='largest_first')
+
+
+@pytest.mark.parametrize("repetitions", [None, 3])
+def test_save_and_load(tmp_path, repetitions):
+    decoder = Decoder(toric33_parity_matrix(), repetitions=repetitions)
+    path = tmp_path / 'toric33.lattice'
+    decoder.save(path)
+    loaded = Decoder.load(path)
+
+    num_vertices = 9 * (repetitions or 1)
+    rng = np.random.default_rng(7)
+    syndromes = rng.binomial(1, 0.1, size=(20, num_vertices))
+    syndromes[:, 0] ^= syndromes.sum(axis=1) % 2
+    for syndrome in syndromes:
+        assert np.all(decoder.decode(syndrome) == loaded.decode(syndrome))
+
+    with open(path, 'wb') as f:
+        f.write(b'not a lattice file')
+    with pytest.raises(ValueError):
+        Decoder.load(path)
+
+
+def test_repetitions_lattice_is_not_materialized():
+    from UnionFindPy._union_find_py import DecoderFromParity
+    repetitions = 4
+    H = toric33_parity_matrix()
+    decoder = Decoder(H, repetitions=repetitions)
+    materialized = DecoderFromParity(H.shape[0], H.shape[1], H.indices, H.indptr,
+            repetitions)
+    assert decoder._decoder.num_edges == materialized.num_edges
+
+    rng = np.random.default_rng(3)
+    for _ in range(20):
+        syndrome = rng.binomial(1, 0.1, size=9 * repetitions)
+        syndrome[0] ^= syndrome.sum() % 2
+        assert np.all(decoder._decoder.decode(syndrome) == materialized.decode(syndrome))
+        decoder._decoder.clear()
+        materialized.clear()
+
+
+@pytest.mark.parametrize("repetitions", [None, 3])
+def test_int64_parity_matrix(repetitions):
+    H = toric33_parity_matrix()
+    H64 = csr_matrix(H)
+    H64.indices = H.indices.astype(np.int64)
+    H64.indptr = H.indptr.astype(np.int64)
+    decoder = Decoder(H, repetitions=repetitions)
+    decoder64 = Decoder(H64, repetitions=repetitions)
+
+    num_vertices = 9 * (repetitions or 1)
+    rng = np.random.default_rng(11)
+    for _ in range(20):
+        syndrome = rng.binomial(1, 0.1, size=num_vertices)
+        syndrome[0] ^= syndrome.sum() % 2
+        assert np.all(decoder.decode(syndrome) == decoder64.decode(syndrome))
+
+
+@pytest.mark.parametrize("repetitions", [None, 3])
+@pytest.mark.parametrize("vertex_order", ['bfs', 'rcm'])
+def test_vertex_order(vertex_order, repetitions):
+    H = toric33_parity_matrix()
+    # rows in a scrambled order
+    H = H[np.random.default_rng(5).permutation(H.shape[0])]
+    reordered = Decoder(H, repetitions=repetitions, vertex_order=vertex_order)
+
+    rng = np.random.default_rng(13)
+    for _ in range(20):
+        noise = rng.binomial(1, 0.1, size=18)
+        syndrome = H @ noise % 2
+        if repetitions is not None:
+            syndrome = np.concatenate([syndrome] + [np.zeros(9, dtype=int)] * 2)
+        corrections = reordered.decode(syndrome)
+        # corrections use the original order of qubits and parities
+        assert np.all(H @ corrections % 2 == H @ noise % 2)
+
+    with pytest.raises(ValueError):
+        Decoder(H, vertex_order='random')
+
+
+@pytest.mark.parametrize("repetitions", [None, 3])
+def test_decode_defects(repetitions):
+    decoder = Decoder(toric33_parity_matrix(), repetitions=repetitions)
+
+    num_vertices = 9 * (repetitions or 1)
+    rng = np.random.default_rng(17)
+    for _ in range(20):
+        syndrome = rng.binomial(1, 0.1, size=num_vertices)
+        syndrome[0] ^= syndrome.sum() % 2
+        expected = np.flatnonzero(decoder.decode(syndrome))
+        corrections = decoder.decode_defects(np.flatnonzero(syndrome))
+        assert corrections.dtype == np.int64
+        assert np.all(corrections == expected)
+
+    assert decoder.decode_defects([]).size == 0
+    with pytest.raises(ValueError):
+        decoder.decode_defects([0, 0])
+    with pytest.raises(ValueError):
+        decoder.decode_defects([num_vertices])
+
+def test_decode_defects_single_layer():
+    decoder = Decoder(toric33_parity_matrix())
+
+    rng = np.random.default_rng(29)
+    syndromes = rng.binomial(1, 0.1, size=(20, 9))
+    syndromes[:, 0] ^= syndromes.sum(axis=1) % 2
+    for syndrome in syndromes:
+        corrections = decoder.decode_defects(np.flatnonzero(syndrome))
+        expected = decoder.decode(syndrome, output='indices')
+        assert corrections.dtype == expected.dtype == np.int64
+        assert np.all(corrections == expected)
+
+def test_decode_defects_folded_layers():
+    decoder = Decoder(toric33_parity_matrix(), repetitions=3)
+
+    rng = np.random.default_rng(19)
+    syndromes = rng.binomial(1, 0.1, size=(20, 27))
+    syndromes[:, 0] ^= syndromes.sum(axis=1) % 2
+    for syndrome in syndromes:
+        corrections = decoder.decode_defects(np.flatnonzero(syndrome))
+        assert corrections.dtype == np.int64
+        assert np.all(corrections == decoder.decode(syndrome, output='indices'))
+
+@pytest.mark.parametrize("repetitions", [None, 3])
+def test_decode_observables(repetitions):
+    rng = np.random.default_rng(23)
+    observables = rng.integers(0, 2, size=(3, 18))
+    decoder = Decoder(toric33_parity_matrix(), repetitions=repetitions,
+            observables=csr_matrix(observables))
+
+    num_vertices = 9 * (repetitions or 1)
+    syndromes = rng.binomial(1, 0.1, size=(20, num_vertices))
+    syndromes[:, 0] ^= syndromes.sum(axis=1) % 2
+    flips = np.array([(observables @ decoder.decode(syndrome)) % 2
+        for syndrome in syndromes])
+    expected = flips @ (1 << np.arange(3))
+
+    assert [decoder.decode_observables(syndrome) for syndrome in syndromes] == list(expected)
+    assert np.all(decoder.decode_batch_observables(syndromes, num_threads=2) == expected)
+
+    with pytest.raises(ValueError):
+        decoder.set_observables(np.ones((65, 18), dtype=int))
+
+@pytest.mark.parametrize("repetitions", [None, 3])
+def test_decode_sparse_and_packed_output(repetitions):
+    decoder = Decoder(toric33_parity_matrix(), repetitions=repetitions)
+
+    num_vertices = 9 * (repetitions or 1)
+    num_qubits = 18
+    rng = np.random.default_rng(31)
+    syndromes = rng.binomial(1, 0.1, size=(20, num_vertices))
+    syndromes[:, 0] ^= syndromes.sum(axis=1) % 2
+
+    for syndrome in syndromes:
+        dense = decoder.decode(syndrome)
+        indices = decoder.decode(syndrome, output='indices')
+        assert indices.dtype == np.int64
+        assert np.all(indices == np.flatnonzero(dense))
+        packed = decoder.decode(syndrome, output='packed')
+        assert packed.dtype == np.uint8
+        assert np.all(np.unpackbits(packed, count=num_qubits) == dense)
+
+    dense = decoder.decode_batch(syndromes, num_threads=2)
+    packed = decoder.decode_batch(syndromes, num_threads=2, output='packed')
+    assert packed.shape == (20, (num_qubits + 7) // 8)
+    assert np.all(np.unpackbits(packed, axis=1, count=num_qubits) == dense)
+
+    with pytest.raises(ValueError):
+        decoder.decode(syndromes[0], output='sparse')
+    with pytest.raises(ValueError):
+        decoder.decode(syndromes[0], out=np.zeros(num_qubits, dtype=int),
+                output='indices')